@@ -0,0 +1,392 @@
+#!/usr/bin/env python3
+"""Stores lock_bench JSON results per machine and git commit, and compares a
+new run against a stored baseline.
+
+Each benchmark must be run with --benchmark_repetitions so there is a sample
+per side. The samples of every benchmark are compared with a two-sided
+Mann-Whitney U test (exact for small samples without ties, normal
+approximation otherwise). p-values are adjusted across benchmarks with
+Benjamini-Hochberg, so running the whole matrix does not flag ~5% of it by
+chance. A benchmark is a REGRESSION when its adjusted p-value is below
+--alpha and its median moved by more than --threshold in the bad direction.
+
+Layout of the store (default: baselines/ at the repository root):
+    baselines/<machine fingerprint>/<git commit>_<kernel>_<libc>.json
+The fingerprint hashes the hardware (host, CPU model, CPU count, caches) so
+results from different hosts are never compared by accident. Kernel and libc
+versions are not part of the fingerprint, since comparing across a kernel or
+glibc upgrade on the same machine is the point, but they are part of the file
+name: a run at the same commit after an upgrade is stored next to the old one.
+record refuses to overwrite a stored run unless --force is given.
+
+lock_bench writes cpu_model, kernel and libc into its JSON context. A --json
+file must carry them, since they describe the machine that produced it, not
+this one; its commit comes from the context or from --commit.
+
+Usage:
+    scripts/bench_baseline.py record  [--force] [--json FILE [--commit COMMIT] | -- <extra lock_bench args>]
+    scripts/bench_baseline.py list
+    scripts/bench_baseline.py compare [--baseline COMMIT|FILE]
+                                      [--json FILE [--commit COMMIT] | -- <extra lock_bench args>]
+
+Without --json, lock_bench is run with --benchmark_repetitions (default 10).
+compare exits with status 1 if any benchmark regressed.
+"""
+
+import argparse
+import hashlib
+import json
+import math
+import os
+import platform
+import re
+import subprocess
+import sys
+import tempfile
+
+ROOT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_STORE = os.path.join(ROOT_DIR, "baselines")
+DEFAULT_BINARY = os.path.join(ROOT_DIR, "build", "shared_vs_regular_mutex", "lock_bench")
+
+# Metrics where a smaller value is better; every other counter (items_per_second,
+# writes, ...) is treated as a rate where larger is better.
+LOWER_IS_BETTER = re.compile(r"^(real_time|cpu_time|think_ns)$|_(p50|p99|p999|max)$")
+
+
+# ---------------------------------------------------------------------------
+# Machine and commit identity
+# ---------------------------------------------------------------------------
+
+
+def git_commit():
+    """HEAD of the repository, with a -dirty suffix for uncommitted changes."""
+    try:
+        commit = subprocess.check_output(["git", "-C", ROOT_DIR, "rev-parse", "--short=12", "HEAD"], text=True).strip()
+        dirty = subprocess.check_output(["git", "-C", ROOT_DIR, "status", "--porcelain", "--untracked-files=no"],
+                                        text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+    return commit + ("-dirty" if dirty else "")
+
+
+def cpu_model():
+    try:
+        with open("/proc/cpuinfo") as f:
+            for line in f:
+                if line.startswith("model name"):
+                    return line.split(":", 1)[1].strip()
+    except OSError:
+        pass
+    return platform.processor() or "unknown"
+
+
+# Context keys that identify the system a result came from.
+HOST_KEYS = ("cpu_model", "kernel", "libc")
+
+
+def annotate_context(result, local, commit=None):
+    """Adds commit, CPU model, kernel and libc to the JSON context. Only a @p local
+    run may take them from this machine; a loaded file must carry its own."""
+    context = result.setdefault("context", {})
+    if commit:
+        context["git_commit"] = commit
+    if local:
+        context.setdefault("git_commit", git_commit())
+        context.setdefault("cpu_model", cpu_model())
+        context.setdefault("kernel", platform.release())
+        context.setdefault("libc", " ".join(platform.libc_ver()).strip() or "unknown")
+    missing = [key for key in ("git_commit",) + HOST_KEYS if key not in context]
+    if missing:
+        sys.exit(f"error: the JSON context lacks {', '.join(missing)}; use lock_bench output "
+                 f"(and --commit for the commit it was built from)")
+    context["machine_fingerprint"] = machine_fingerprint(context)
+
+
+def machine_fingerprint(context):
+    hardware = [
+        context.get("host_name"),
+        context.get("cpu_model"),
+        context.get("num_cpus"),
+        [(c.get("type"), c.get("level"), c.get("size")) for c in context.get("caches", [])],
+    ]
+    return hashlib.sha1(json.dumps(hardware, sort_keys=True).encode()).hexdigest()[:12]
+
+
+# ---------------------------------------------------------------------------
+# Running and loading results
+# ---------------------------------------------------------------------------
+
+
+def run_lock_bench(binary, repetitions, extra_args):
+    if not os.access(binary, os.X_OK):
+        sys.exit(f"error: {binary} not found; build it or pass --binary / --json")
+    with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as out:
+        out_path = out.name
+    try:
+        cmd = [binary, f"--benchmark_repetitions={repetitions}", f"--benchmark_out={out_path}",
+               "--benchmark_out_format=json"] + extra_args
+        print("running:", " ".join(cmd), file=sys.stderr)
+        subprocess.run(cmd, check=True, stdout=sys.stderr)
+        with open(out_path) as f:
+            return json.load(f)
+    finally:
+        os.unlink(out_path)
+
+
+def load_or_run(args):
+    if args.json:
+        with open(args.json) as f:
+            result = json.load(f)
+    else:
+        if args.commit:
+            sys.exit("error: --commit only applies to --json input")
+        result = run_lock_bench(args.binary, args.repetitions, args.extra)
+    annotate_context(result, local=not args.json, commit=args.commit)
+    return result
+
+
+def samples_by_benchmark(result, metric):
+    """{run_name: [metric per repetition]} from the per-repetition (non-aggregate) rows."""
+    samples = {}
+    for bench in result.get("benchmarks", []):
+        if bench.get("run_type", "iteration") != "iteration" or bench.get("error_occurred"):
+            continue
+        if metric not in bench:
+            continue
+        samples.setdefault(bench.get("run_name", bench["name"]), []).append(float(bench[metric]))
+    return samples
+
+
+# ---------------------------------------------------------------------------
+# Store
+# ---------------------------------------------------------------------------
+
+
+def store_path(store, context):
+    """One file per commit, kernel and libc, so an upgrade never replaces the run before it."""
+    key = "_".join(context[k] for k in ("git_commit", "kernel", "libc"))
+    return os.path.join(store, context["machine_fingerprint"], re.sub(r"[^A-Za-z0-9._+-]+", "-", key) + ".json")
+
+
+def stored_runs(store, fingerprint):
+    """Stored results of one machine, oldest first, as (path, context)."""
+    machine_dir = os.path.join(store, fingerprint)
+    runs = []
+    if os.path.isdir(machine_dir):
+        for name in os.listdir(machine_dir):
+            if name.endswith(".json"):
+                path = os.path.join(machine_dir, name)
+                with open(path) as f:
+                    runs.append((path, json.load(f).get("context", {})))
+    runs.sort(key=lambda run: (run[1].get("date", ""), run[0]))
+    return runs
+
+
+def find_baseline(args, context):
+    if args.baseline and os.path.isfile(args.baseline):
+        return args.baseline
+    runs = stored_runs(args.store, context["machine_fingerprint"])
+    if args.baseline:
+        matches = [path for path, ctx in runs if ctx.get("git_commit", "").startswith(args.baseline)]
+        if not matches:
+            sys.exit(f"error: no baseline for commit {args.baseline} on machine {context['machine_fingerprint']}")
+        return matches[-1]
+    # Newest baseline of this machine, even at the same commit: a kernel or libc
+    # upgrade is compared against the run recorded before it.
+    if not runs:
+        sys.exit(f"error: no stored baseline for machine {context['machine_fingerprint']}; run `record` first")
+    return runs[-1][0]
+
+
+# ---------------------------------------------------------------------------
+# Statistics
+# ---------------------------------------------------------------------------
+
+
+def median(values):
+    ordered = sorted(values)
+    mid = len(ordered) // 2
+    return ordered[mid] if len(ordered) % 2 else (ordered[mid - 1] + ordered[mid]) / 2
+
+
+def ranks(values):
+    """Ranks starting at 1; ties get the mean of the ranks they span."""
+    order = sorted(range(len(values)), key=lambda i: values[i])
+    result = [0.0] * len(values)
+    i = 0
+    while i < len(order):
+        j = i
+        while j + 1 < len(order) and values[order[j + 1]] == values[order[i]]:
+            j += 1
+        for k in range(i, j + 1):
+            result[order[k]] = (i + j) / 2 + 1
+        i = j + 1
+    return result
+
+
+def exact_u_distribution(n1, n2):
+    """Number of orderings giving each U = 0..n1*n2 (no ties)."""
+    # counts[a][b] is the distribution for sample sizes a and b; built row by row.
+    prev = [[1] for _ in range(n2 + 1)]  # a = 0: U is always 0
+    for a in range(1, n1 + 1):
+        cur = [[1]]  # b = 0: U is always 0
+        for b in range(1, n2 + 1):
+            # The largest observation is from sample 1 (adds b to U) or from sample 2.
+            dist = [0] * (a * b + 1)
+            for u, count in enumerate(prev[b]):
+                dist[u + b] += count
+            for u, count in enumerate(cur[b - 1]):
+                dist[u] += count
+            cur.append(dist)
+        prev = cur
+    return prev[n2]
+
+
+def mann_whitney_u(x, y):
+    """Two-sided Mann-Whitney U test; returns (U of x, p-value)."""
+    n1, n2 = len(x), len(y)
+    combined = x + y
+    r = ranks(combined)
+    u1 = sum(r[:n1]) - n1 * (n1 + 1) / 2
+    has_ties = len(set(combined)) < len(combined)
+    if not has_ties and n1 * n2 <= 400:
+        dist = exact_u_distribution(n1, n2)
+        total = sum(dist)
+        u = int(round(u1))
+        lower = sum(dist[: u + 1]) / total
+        upper = sum(dist[u:]) / total
+        return u1, min(1.0, 2 * min(lower, upper))
+    n = n1 + n2
+    tie_term = 0
+    for value in set(combined):
+        t = combined.count(value)
+        tie_term += t ** 3 - t
+    variance = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0:
+        return u1, 1.0
+    z = (abs(u1 - n1 * n2 / 2) - 0.5) / math.sqrt(variance)
+    return u1, min(1.0, math.erfc(max(z, 0) / math.sqrt(2)))
+
+
+def benjamini_hochberg(p_values):
+    """Adjusted p-values (q-values) in the input order."""
+    m = len(p_values)
+    order = sorted(range(m), key=lambda i: p_values[i])
+    adjusted = [1.0] * m
+    running = 1.0
+    for rank in range(m, 0, -1):
+        i = order[rank - 1]
+        running = min(running, p_values[i] * m / rank)
+        adjusted[i] = running
+    return adjusted
+
+
+# ---------------------------------------------------------------------------
+# Commands
+# ---------------------------------------------------------------------------
+
+
+def cmd_record(args):
+    result = load_or_run(args)
+    path = store_path(args.store, result["context"])
+    if os.path.exists(path) and not args.force:
+        sys.exit(f"error: {path} exists; pass --force to replace it")
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w") as f:
+        json.dump(result, f, indent=2)
+    print(f"stored {path}")
+
+
+def cmd_list(args):
+    if not os.path.isdir(args.store):
+        print(f"no baselines in {args.store}")
+        return
+    for fingerprint in sorted(os.listdir(args.store)):
+        for path, ctx in stored_runs(args.store, fingerprint):
+            print(f"{fingerprint}  {ctx.get('git_commit', '?'):18} {ctx.get('date', '?'):26} "
+                  f"{ctx.get('host_name', '?')}  kernel {ctx.get('kernel', '?')}  {ctx.get('libc', '?')}")
+
+
+def cmd_compare(args):
+    result = load_or_run(args)
+    context = result["context"]
+    baseline_path = find_baseline(args, context)
+    with open(baseline_path) as f:
+        baseline = json.load(f)
+    base_ctx = baseline.get("context", {})
+    print(f"baseline  {base_ctx.get('git_commit', '?')}  kernel {base_ctx.get('kernel', '?')}  "
+          f"{base_ctx.get('libc', '?')}  ({baseline_path})")
+    print(f"current   {context['git_commit']}  kernel {context['kernel']}  {context['libc']}")
+    if base_ctx.get("machine_fingerprint", context["machine_fingerprint"]) != context["machine_fingerprint"]:
+        print("warning: baseline was recorded on a different machine", file=sys.stderr)
+    # Host settings lock_bench records as env_* keys (governor, turbo, SMT, ...).
+    for key in sorted(k for k in set(base_ctx) & set(context) if k.startswith("env_") and k != "env_loadavg_1m"):
+        if base_ctx[key] != context[key]:
+            print(f"warning: {key} changed: {base_ctx[key]} -> {context[key]}", file=sys.stderr)
+
+    lower_is_better = LOWER_IS_BETTER.search(args.metric) is not None
+    base_samples = samples_by_benchmark(baseline, args.metric)
+    new_samples = samples_by_benchmark(result, args.metric)
+    names = [name for name in new_samples if name in base_samples and re.search(args.filter, name)]
+    if not names:
+        sys.exit("error: no benchmarks in common with the baseline")
+
+    rows = []
+    for name in names:
+        base, new = base_samples[name], new_samples[name]
+        _, p = mann_whitney_u(base, new)
+        base_median, new_median = median(base), median(new)
+        change = (new_median - base_median) / base_median if base_median else 0.0
+        rows.append([name, base_median, new_median, change, p, min(len(base), len(new))])
+    for row, q in zip(rows, benjamini_hochberg([row[4] for row in rows])):
+        row.append(q)
+
+    regressions = 0
+    width = max(len(row[0]) for row in rows)
+    print(f"\n{'benchmark':{width}}  {'base':>12}  {'new':>12}  {'change':>8}  {'p':>7}  {'q':>7}  verdict")
+    for name, base_median, new_median, change, p, reps, q in rows:
+        worse = change > 0 if lower_is_better else change < 0
+        verdict = ""
+        if q < args.alpha and abs(change) > args.threshold:
+            verdict = "REGRESSION" if worse else "improved"
+            regressions += worse
+        elif reps < 4:
+            verdict = "too few repetitions"
+        print(f"{name:{width}}  {base_median:12.5g}  {new_median:12.5g}  {change:+8.2%}  {p:7.4f}  {q:7.4f}  {verdict}")
+    print(f"\n{regressions} regression(s) in {len(rows)} benchmarks "
+          f"({args.metric}, {'lower' if lower_is_better else 'higher'} is better, "
+          f"q < {args.alpha}, |change| > {args.threshold:.1%})")
+    return 1 if regressions else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--store", default=DEFAULT_STORE, help="baseline directory (default: %(default)s)")
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    def add_run_options(p):
+        p.add_argument("--json", help="use this lock_bench JSON output instead of running lock_bench")
+        p.add_argument("--commit", help="git commit the --json output was produced at, if its context lacks one")
+        p.add_argument("--binary", default=DEFAULT_BINARY, help="lock_bench to run (default: %(default)s)")
+        p.add_argument("--repetitions", type=int, default=10, help="--benchmark_repetitions (default: %(default)s)")
+        p.add_argument("extra", nargs="*", help="extra lock_bench arguments, after --")
+
+    record = sub.add_parser("record", help="run or load results and store them as a baseline")
+    add_run_options(record)
+    record.add_argument("--force", action="store_true", help="replace a stored run with the same key")
+    sub.add_parser("list", help="list stored baselines")
+    compare = sub.add_parser("compare", help="compare a run against a stored baseline")
+    add_run_options(compare)
+    compare.add_argument("--baseline", help="baseline commit (prefix) or JSON file (default: newest for this machine)")
+    compare.add_argument("--metric", default="real_time", help="field or counter to compare (default: %(default)s)")
+    compare.add_argument("--filter", default="", help="only compare benchmarks matching this regex")
+    compare.add_argument("--alpha", type=float, default=0.05, help="significance level (default: %(default)s)")
+    compare.add_argument("--threshold", type=float, default=0.02,
+                         help="minimum relative change of the median to flag (default: %(default)s)")
+
+    args = parser.parse_args()
+    return {"record": cmd_record, "list": cmd_list, "compare": cmd_compare}[args.command](args) or 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,30 @@
+#!/usr/bin/env bash
+#
+# Builds lock_bench in the TSan and ASan CMake configurations and
+# runs the `smoke` target in each: a short pass of every registered benchmark
+# (every lock variant and thread count). Stops at the first sanitizer report.
+#
+# Run this before trusting the numbers of a new lock implementation.
+#
+# Usage: scripts/run_sanitizers.sh
+#   SANITIZERS="TSan"       only run one configuration (default: "TSan ASan")
+#   OUT_DIR=/tmp/sanitize   where the build trees go (default: _sanitize/)
+
+set -euo pipefail
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+OUT_DIR="${OUT_DIR:-$ROOT_DIR/_sanitize}"
+SANITIZERS="${SANITIZERS:-TSan ASan}"
+
+export TSAN_OPTIONS="halt_on_error=1 second_deadlock_stack=1 ${TSAN_OPTIONS:-}"
+export ASAN_OPTIONS="halt_on_error=1 detect_leaks=1 ${ASAN_OPTIONS:-}"
+export UBSAN_OPTIONS="halt_on_error=1 print_stacktrace=1 ${UBSAN_OPTIONS:-}"
+
+for config in $SANITIZERS; do
+    echo "==> [$config] configuring"
+    cmake -S "$ROOT_DIR" -B "$OUT_DIR/$config" -DCMAKE_BUILD_TYPE="$config"
+    echo "==> [$config] building and running smoke"
+    cmake --build "$OUT_DIR/$config" --target smoke -j"$(nproc)"
+done
+
+echo "==> sanitizers clean: $SANITIZERS"
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Fits the Universal Scalability Law to the thread sweeps in lock_bench JSON output.
+
+For every benchmark family (the name without /threads:N, or without
+/participants=N for the cross-process rows, which start their own workers),
+the read throughput X(N) (the "reads" counter) is fitted against the number
+of reader threads N (the "readers" counter) with
+
+    X(N) = X(1) * N / (1 + sigma * (N - 1) + kappa * N * (N - 1))
+
+sigma is contention (the serialized fraction, Amdahl's term) and kappa is
+coherency (the cost of keeping N readers' caches in agreement, e.g. bouncing
+a reader count). Following Gunther, the single-reader run gives X(1), and
+N / C(N) - 1 = sigma * (N - 1) + kappa * N * (N - 1) with C(N) = X(N) / X(1)
+is fitted by least squares. Scaling efficiency is C(N) / N.
+
+Most benchmarks dedicate thread 0 to writing, so their single-reader run is
+threads:2. A fit needs at least three reader counts; sweep densely with:
+
+    lock_bench --lock_bench_threads=2,3,4,5,6,7,8,9 --benchmark_filter='load=closed' \\
+               --benchmark_out=sweep.json
+    scripts/usl_fit.py sweep.json
+
+Usage: scripts/usl_fit.py RESULTS.json [--filter REGEX] [--predict 16,32,64]
+"""
+
+import argparse
+import json
+import math
+import re
+import sys
+
+
+def throughput_by_family(result, name_filter):
+    """{family: {readers: mean reads/s}} from per-repetition or plain runs."""
+    sums = {}
+    for bench in result.get("benchmarks", []):
+        if bench.get("run_type", "iteration") != "iteration" or bench.get("error_occurred"):
+            continue
+        if "reads" not in bench or "readers" not in bench:
+            continue
+        readers = int(round(bench["readers"]))
+        if readers < 1:
+            continue
+        family = re.sub(r"/(threads:|participants=)\d+", "", bench.get("run_name", bench["name"]))
+        if not re.search(name_filter, family):
+            continue
+        total, count = sums.setdefault(family, {}).get(readers, (0.0, 0))
+        sums[family][readers] = (total + float(bench["reads"]), count + 1)
+    return {family: {n: total / count for n, (total, count) in points.items()} for family, points in sums.items()}
+
+
+def least_squares(basis, targets):
+    """Coefficients minimizing the squared error of targets ~ sum(c_i * basis_i); no intercept."""
+    if len(basis) == 1:
+        f = basis[0]
+        denom = sum(v * v for v in f)
+        return [sum(a * b for a, b in zip(f, targets)) / denom] if denom else None
+    f1, f2 = basis
+    s11 = sum(v * v for v in f1)
+    s12 = sum(a * b for a, b in zip(f1, f2))
+    s22 = sum(v * v for v in f2)
+    b1 = sum(a * b for a, b in zip(f1, targets))
+    b2 = sum(a * b for a, b in zip(f2, targets))
+    det = s11 * s22 - s12 * s12
+    if det == 0:
+        return None
+    return [(b1 * s22 - b2 * s12) / det, (s11 * b2 - s12 * b1) / det]
+
+
+def fit_usl(points):
+    """(sigma, kappa, r_squared) for {readers: throughput}; None without X(1) or 3 reader counts.
+
+    sigma and kappa are constrained to be non-negative: if the free fit makes
+    one negative (noise, or superlinear cache effects), that term is dropped
+    and the other is refitted alone.
+    """
+    if 1 not in points or len(points) < 3:
+        return None
+    x1 = points[1]
+    ns = [n for n in sorted(points) if n != 1]
+    contention = [n - 1 for n in ns]
+    coherency = [n * (n - 1) for n in ns]
+    y = [n * x1 / points[n] - 1 for n in ns]
+
+    candidates = []
+    both = least_squares([contention, coherency], y)
+    if both and both[0] >= 0 and both[1] >= 0:
+        candidates.append((both[0], both[1]))
+    else:
+        only_sigma = least_squares([contention], y)
+        only_kappa = least_squares([coherency], y)
+        if only_sigma:
+            candidates.append((max(only_sigma[0], 0.0), 0.0))
+        if only_kappa:
+            candidates.append((0.0, max(only_kappa[0], 0.0)))
+    if not candidates:
+        return None
+
+    def residual(params):
+        return sum((x - predict(x1, params[0], params[1], n)) ** 2 for n, x in points.items())
+
+    sigma, kappa = min(candidates, key=residual)
+    mean = sum(points.values()) / len(points)
+    ss_tot = sum((x - mean) ** 2 for x in points.values())
+    r_squared = 1 - residual((sigma, kappa)) / ss_tot if ss_tot else 1.0
+    return sigma, kappa, r_squared
+
+
+def predict(x1, sigma, kappa, n):
+    return x1 * n / (1 + sigma * (n - 1) + kappa * n * (n - 1))
+
+
+def peak_readers(sigma, kappa):
+    """Reader count of maximum throughput, or None if the model never peaks."""
+    if kappa <= 0 or sigma >= 1:
+        return None
+    return math.sqrt((1 - sigma) / kappa)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("results", help="Google Benchmark JSON output (--benchmark_out)")
+    parser.add_argument("--filter", default="", help="only fit benchmark families matching this regex")
+    parser.add_argument("--predict", default="16,32,64", help="reader counts to extrapolate efficiency to")
+    args = parser.parse_args()
+
+    with open(args.results) as f:
+        result = json.load(f)
+    families = throughput_by_family(result, args.filter)
+    num_cpus = result.get("context", {}).get("num_cpus", 0)
+    max_threads = max((b.get("threads", 1) for b in result.get("benchmarks", [])), default=1)
+    if num_cpus and max_threads > num_cpus:
+        print(f"warning: runs used up to {max_threads} threads on {num_cpus} CPUs; "
+              "oversubscribed points measure the scheduler, not the lock", file=sys.stderr)
+    targets = [int(n) for n in args.predict.split(",") if n]
+    if not families:
+        sys.exit("error: no benchmarks with reads/readers counters in the results")
+
+    width = max(len(family) for family in families)
+    header = f"{'benchmark':{width}}  {'sigma':>8}  {'kappa':>9}  {'R^2':>6}  {'peak N':>7}"
+    header += "".join(f"  {'E(' + str(n) + ')':>6}" for n in targets) + "  measured E(N)"
+    print(header)
+    for family in sorted(families):
+        points = families[family]
+        measured = "  ".join(
+            f"{n}:{points[n] / (n * points[1]):.0%}" for n in sorted(points)) if 1 in points else ""
+        fit = fit_usl(points)
+        if fit is None:
+            print(f"{family:{width}}  {'needs X(1) and 3+ reader counts':>34}  {measured}")
+            continue
+        sigma, kappa, r_squared = fit
+        peak = peak_readers(sigma, kappa)
+        row = f"{family:{width}}  {sigma:8.4f}  {kappa:9.5f}  {r_squared:6.3f}  "
+        row += f"{peak:7.1f}" if peak is not None else f"{'-':>7}"
+        row += "".join(f"  {predict(1.0, sigma, kappa, n) / n:6.0%}" for n in targets)
+        print(f"{row}  {measured}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
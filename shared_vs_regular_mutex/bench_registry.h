@@ -0,0 +1,249 @@
+/**
+ * @file bench_registry.h
+ * @brief Structured benchmark names and per-run contexts for the single lock_bench binary.
+ * * DESIGN PRINCIPLE:
+ * Every benchmark is named as a path of key=value dimensions, e.g.
+ * "lock=shared_mutex/container=map/read=light/write=update/load=closed",
+ * followed by Google Benchmark's own "/real_time/threads:8". A
+ * --benchmark_filter regex or a script over the JSON output can then slice
+ * the matrix along any dimension, and no two suites can produce the same name.
+ *
+ * Benchmarks are registered by plain functions called from main(), so the
+ * order is deterministic. Each registration owns its own ContextScope:
+ * thread 0 builds the context and all threads then meet at a barrier, so the
+ * context is complete before any thread touches it and nobody races on
+ * setup. A second barrier lets thread 0 destroy it only after every thread is
+ * done. State written by one benchmark (e.g. a growing data[0]) can never
+ * leak into another, whatever the registration order.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class BenchName
+ * @brief Builds a "key=value/key=value" benchmark name, one dimension at a time.
+ */
+class BenchName
+{
+  public:
+    BenchName &Add(const std::string &key, const std::string &value)
+    {
+        if (!name_.empty())
+        {
+            name_ += '/';
+        }
+        name_ += key + '=' + value;
+        return *this;
+    }
+
+    BenchName &Add(const std::string &key, long long value)
+    {
+        return Add(key, std::to_string(value));
+    }
+
+    const std::string &str() const
+    {
+        return name_;
+    }
+
+  private:
+    std::string name_;
+};
+
+/**
+ * @brief Thread counts every multi-threaded benchmark runs at; {2, 4, 8} unless
+ * --lock_bench_threads overrides it.
+ */
+inline std::vector<int> &ThreadSweep()
+{
+    static std::vector<int> sweep{ 2, 4, 8 };
+    return sweep;
+}
+
+/**
+ * @brief Consumes --lock_bench_threads=2,3,4,... from the command line. Must run
+ * before registration. A dense sweep gives scripts/usl_fit.py more points to
+ * fit. Returns false if the list is malformed.
+ */
+inline bool ParseThreadSweepFlag(int *argc, char **argv)
+{
+    static const char kFlag[] = "--lock_bench_threads=";
+    bool ok = true;
+    int kept = 1;
+    for (int i = 1; i < *argc; ++i)
+    {
+        if (std::strncmp(argv[i], kFlag, sizeof(kFlag) - 1) != 0)
+        {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        std::vector<int> sweep;
+        std::stringstream list(argv[i] + sizeof(kFlag) - 1);
+        std::string item;
+        while (std::getline(list, item, ','))
+        {
+            const int threads = std::atoi(item.c_str());
+            ok = ok && threads > 0;
+            sweep.push_back(threads);
+        }
+        ok = ok && !sweep.empty();
+        ThreadSweep() = sweep;
+    }
+    *argc = kept;
+    return ok;
+}
+
+/**
+ * @brief Minimum run length of a load=schedule benchmark, in writer periods,
+ * so that every run sees several events; 10 unless --lock_bench_schedule_periods
+ * overrides it. 0 leaves the run length to --benchmark_min_time.
+ */
+inline int &SchedulePeriodsPerRun()
+{
+    static int periods = 10;
+    return periods;
+}
+
+/**
+ * @brief Consumes --lock_bench_schedule_periods=N from the command line. Must
+ * run before registration. The smoke target passes 0, since ten periods of
+ * every schedule row take minutes whatever --benchmark_min_time says.
+ * Returns false unless N is a non-negative integer.
+ */
+inline bool ParseSchedulePeriodsFlag(int *argc, char **argv)
+{
+    static const char kFlag[] = "--lock_bench_schedule_periods=";
+    bool ok = true;
+    int kept = 1;
+    for (int i = 1; i < *argc; ++i)
+    {
+        if (std::strncmp(argv[i], kFlag, sizeof(kFlag) - 1) != 0)
+        {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        const char *value = argv[i] + sizeof(kFlag) - 1;
+        char *end = nullptr;
+        const long periods = std::strtol(value, &end, 10);
+        ok = ok && end != value && *end == '\0' && periods >= 0 && periods <= 1000;
+        SchedulePeriodsPerRun() = static_cast<int>(periods);
+    }
+    *argc = kept;
+    return ok;
+}
+
+/**
+ * @brief Benchmark::Apply callback: one run per thread count of ThreadSweep().
+ */
+inline void SweepThreads(benchmark::internal::Benchmark *bench)
+{
+    for (int threads : ThreadSweep())
+    {
+        bench->Threads(threads);
+    }
+}
+
+/**
+ * @brief Per-thread epilogue of a benchmark with dedicated reader threads.
+ * "reads" sums into the total read throughput and "readers" is the number of
+ * reading threads; scripts/usl_fit.py fits one against the other.
+ */
+inline void ReportReads(benchmark::State &state, std::int64_t reads, int readers)
+{
+    state.counters["reads"] = benchmark::Counter(static_cast<double>(reads), benchmark::Counter::kIsRate);
+    state.counters["readers"] = benchmark::Counter(readers, benchmark::Counter::kAvgThreads);
+}
+
+/**
+ * @class SpinBarrier
+ * @brief Reusable generation-counting barrier for a varying number of threads.
+ * Only used outside the timed region, so it yields instead of spinning hot.
+ */
+class SpinBarrier
+{
+  public:
+    void Wait(int participants)
+    {
+        const unsigned generation = generation_.load(std::memory_order_acquire);
+        if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == participants)
+        {
+            arrived_.store(0, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        while (generation_.load(std::memory_order_acquire) == generation)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+  private:
+    std::atomic<int> arrived_{ 0 };
+    std::atomic<unsigned> generation_{ 0 };
+};
+
+/**
+ * @class ContextScope
+ * @brief Owns one @p Context per benchmark run; @p Context must provide setup().
+ * Every benchmark thread calls SetUp before and TearDown after its timed loop.
+ */
+template <typename Context>
+class ContextScope
+{
+  public:
+    void SetUp(benchmark::State &state)
+    {
+        if (state.thread_index() == 0)
+        {
+            ctx_ = std::make_unique<Context>();
+            ctx_->setup();
+        }
+        barrier_.Wait(state.threads());
+    }
+
+    void TearDown(benchmark::State &state)
+    {
+        barrier_.Wait(state.threads());
+        if (state.thread_index() == 0)
+        {
+            ctx_.reset();
+        }
+    }
+
+    /// @brief The context of the current run; valid between SetUp and TearDown.
+    Context &ctx()
+    {
+        return *ctx_;
+    }
+
+  private:
+    std::unique_ptr<Context> ctx_;
+    SpinBarrier barrier_;
+};
+
+/**
+ * @brief Registers @p body as benchmark @p name; body(state, ctx) runs on every
+ * thread against a @p Context that is rebuilt for each run.
+ */
+template <typename Context, typename Body>
+benchmark::internal::Benchmark *RegisterWithContext(const BenchName &name, Body body)
+{
+    auto scope = std::make_shared<ContextScope<Context>>();
+    return benchmark::RegisterBenchmark(name.str().c_str(), [scope, body](benchmark::State &state) {
+        scope->SetUp(state);
+        body(state, scope->ctx());
+        scope->TearDown(state);
+    });
+}
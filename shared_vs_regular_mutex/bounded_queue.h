@@ -0,0 +1,119 @@
+/**
+ * @file bounded_queue.h
+ * @brief Bounded lock-free multi-producer queue (Vyukov), for coalescing writes.
+ * * DESIGN PRINCIPLE:
+ * A producer claims a cell with one compare-and-swap on the tail and
+ * publishes it by bumping the cell's sequence number; the consumer does the
+ * same on the head. Producers never wait for the consumer or for the lock
+ * that guards the data, so queueing an update costs about as much as one
+ * uncontended atomic. Cells are preallocated: a full queue is back-pressure
+ * (TryPush fails) rather than an allocation.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @class BoundedQueue
+ * @brief Fixed-capacity FIFO; capacity is rounded up to a power of two.
+ */
+template <typename T>
+class BoundedQueue
+{
+  public:
+    explicit BoundedQueue(std::size_t capacity) : mask_(RoundUpPow2(capacity) - 1), cells_(new Cell[mask_ + 1])
+    {
+        for (std::size_t i = 0; i <= mask_; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Appends @p value; returns false if the queue is full.
+     */
+    bool TryPush(const T &value)
+    {
+        std::size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells_[pos & mask_];
+            const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0)
+            {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Removes the oldest value into @p out; returns false if the queue is empty.
+     */
+    bool TryPop(T &out)
+    {
+        std::size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells_[pos & mask_];
+            const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    out = cell.value;
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+  private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    static std::size_t RoundUpPow2(std::size_t n)
+    {
+        std::size_t pow2 = 1;
+        while (pow2 < n)
+        {
+            pow2 <<= 1;
+        }
+        return pow2;
+    }
+
+    const std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    /// @brief Producers and the consumer each get their own cache line.
+    alignas(64) std::atomic<std::size_t> tail_{ 0 };
+    alignas(64) std::atomic<std::size_t> head_{ 0 };
+};
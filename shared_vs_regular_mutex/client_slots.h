@@ -0,0 +1,101 @@
+/**
+ * @file client_slots.h
+ * @brief Per-thread publication slots for policies that run critical sections on another thread.
+ * * DESIGN PRINCIPLE:
+ * Flat combining and delegation both hand a critical section to some other
+ * thread and spin until it has run. Each client gets its own cache-line
+ * sized slot, so publishing a request and waiting for the reply touch a
+ * line no other client writes; only the executing thread visits them all.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * @struct PublishedOp
+ * @brief One client's pending critical section, type-erased.
+ * The client writes invoke/arg and then raises `pending` (release); the
+ * executor sees them after reading `pending` (acquire), runs the operation
+ * and lowers `pending` (release), which is the reply.
+ */
+struct alignas(64) PublishedOp
+{
+    std::atomic<bool> pending{ false };
+    void (*invoke)(void *) = nullptr;
+    void *arg = nullptr;
+
+    /**
+     * @brief Publishes @p fn; it must stay alive until `pending` drops.
+     */
+    template <typename Fn>
+    void Publish(Fn &fn)
+    {
+        invoke = [](void *p) { (*static_cast<Fn *>(p))(); };
+        arg = &fn;
+        pending.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Executor side: runs the operation if one is pending. Returns true if it did.
+     */
+    bool RunIfPending()
+    {
+        if (!pending.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        invoke(arg);
+        pending.store(false, std::memory_order_release);
+        return true;
+    }
+};
+
+/**
+ * @class ClientRegistry
+ * @brief Hands each thread a dense slot index the first time it uses one lock object.
+ * Every thread remembers its index in each lock it has used, so a thread
+ * that alternates between locks keeps one slot in each; the lock it used
+ * last is checked first. Indices are keyed by a per-object id rather than
+ * the address, since the context of a later run can reuse the memory of a
+ * destroyed one.
+ */
+class ClientRegistry
+{
+  public:
+    ClientRegistry() : id_(next_id_.fetch_add(1, std::memory_order_relaxed) + 1)
+    {
+    }
+
+    /// @brief This thread's index; may exceed any slot array the caller owns.
+    int Index()
+    {
+        thread_local std::uint64_t last_owner = 0;
+        thread_local int last_index = -1;
+        thread_local std::unordered_map<std::uint64_t, int> indices;
+        if (last_owner != id_)
+        {
+            const auto [entry, inserted] = indices.try_emplace(id_, 0);
+            if (inserted)
+            {
+                entry->second = used_.fetch_add(1, std::memory_order_acq_rel);
+            }
+            last_owner = id_;
+            last_index = entry->second;
+        }
+        return last_index;
+    }
+
+    /// @brief Number of indices handed out so far.
+    int Used() const
+    {
+        return used_.load(std::memory_order_acquire);
+    }
+
+  private:
+    static inline std::atomic<std::uint64_t> next_id_{ 0 };
+    alignas(64) std::atomic<int> used_{ 0 };
+    const std::uint64_t id_;
+};
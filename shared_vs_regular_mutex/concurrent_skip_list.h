@@ -0,0 +1,515 @@
+/**
+ * @file concurrent_skip_list.h
+ * @brief Lazily-locked concurrent skip list (Herlihy, Lev, Luchangco, Shavit).
+ * * DESIGN PRINCIPLE:
+ * Lookups and range scans never take a lock: they walk the towers with acquire
+ * loads and only look at the `marked` / `fully_linked` flags. Inserts and erases
+ * lock just the predecessors they splice, so disjoint writers do not serialize
+ * and readers never block behind a writer. Unlinked nodes are reclaimed by
+ * epochs: every operation pins the current epoch in its thread's own slot,
+ * and a node retired in epoch E is freed once no slot holds an epoch <= E.
+ */
+
+#pragma once
+
+#include "client_slots.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @class ConcurrentSkipList
+ * @brief Ordered map with wait-free reads and fine-grained locked updates.
+ * * Erased nodes are parked on a retired stack, since readers may still be
+ * standing on them. Every kReclaimBatch retirements the list advances the
+ * epoch and frees the nodes no pinned operation can reach any more, so
+ * memory stays bounded however long erases go on. Threads beyond
+ * kEpochSlots share one pin counter, which holds reclamation off while any
+ * of them is inside an operation.
+ */
+template <typename Key, typename Value, int MaxLevel = 12>
+class ConcurrentSkipList
+{
+  public:
+    /// @brief Threads that pin epochs in a slot of their own.
+    static constexpr int kEpochSlots = 64;
+    /// @brief Retired nodes that trigger a reclamation pass.
+    static constexpr int kReclaimBatch = 64;
+
+    ConcurrentSkipList()
+    {
+        head_ = new Node(Key{}, Value{}, MaxLevel - 1);
+        tail_ = new Node(Key{}, Value{}, MaxLevel - 1);
+        for (int level = 0; level < MaxLevel; ++level)
+        {
+            head_->next[level].store(tail_, std::memory_order_relaxed);
+        }
+        head_->fully_linked.store(true, std::memory_order_relaxed);
+        tail_->fully_linked.store(true, std::memory_order_relaxed);
+    }
+
+    ConcurrentSkipList(const ConcurrentSkipList &) = delete;
+    ConcurrentSkipList &operator=(const ConcurrentSkipList &) = delete;
+
+    ~ConcurrentSkipList()
+    {
+        Node *node = head_->next[0].load(std::memory_order_relaxed);
+        while (node != tail_)
+        {
+            Node *next = node->next[0].load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+        Node *retired = retired_.load(std::memory_order_relaxed);
+        while (retired != nullptr)
+        {
+            Node *next = retired->retired_next;
+            delete retired;
+            retired = next;
+        }
+        delete head_;
+        delete tail_;
+    }
+
+    /**
+     * @brief Returns true if the list holds no live keys.
+     */
+    bool empty() const
+    {
+        return head_->next[0].load(std::memory_order_acquire) == tail_;
+    }
+
+    /**
+     * @brief Wait-free membership test.
+     */
+    bool contains(const Key &key) const
+    {
+        const EpochGuard pin(*this);
+        Node *preds[MaxLevel];
+        Node *succs[MaxLevel];
+        int found = find(key, preds, succs);
+        return found != -1 && succs[found]->fully_linked.load(std::memory_order_acquire) &&
+               !succs[found]->marked.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Wait-free lookup. Writes the value to @p out and returns true if present.
+     */
+    bool find_value(const Key &key, Value &out) const
+    {
+        const EpochGuard pin(*this);
+        Node *preds[MaxLevel];
+        Node *succs[MaxLevel];
+        int found = find(key, preds, succs);
+        if (found == -1)
+        {
+            return false;
+        }
+        Node *node = succs[found];
+        if (!node->fully_linked.load(std::memory_order_acquire) || node->marked.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        out = node->value.load(std::memory_order_acquire);
+        return true;
+    }
+
+    /**
+     * @brief Inserts @p key if absent. Returns false if it was already present.
+     */
+    bool insert(const Key &key, const Value &value)
+    {
+        const EpochGuard pin(*this);
+        const int top_level = RandomLevel();
+        Node *preds[MaxLevel];
+        Node *succs[MaxLevel];
+        while (true)
+        {
+            int found = find(key, preds, succs);
+            if (found != -1)
+            {
+                Node *existing = succs[found];
+                if (!existing->marked.load(std::memory_order_acquire))
+                {
+                    // Another inserter won; wait until its tower is complete.
+                    while (!existing->fully_linked.load(std::memory_order_acquire))
+                    {
+                    }
+                    return false;
+                }
+                // Being erased right now: retry until it is unlinked.
+                continue;
+            }
+
+            int highest_locked = -1;
+            bool valid = true;
+            Node *prev_pred = nullptr;
+            for (int level = 0; valid && level <= top_level; ++level)
+            {
+                Node *pred = preds[level];
+                Node *succ = succs[level];
+                if (pred != prev_pred)
+                {
+                    pred->lock.lock();
+                    prev_pred = pred;
+                }
+                highest_locked = level;
+                valid = !pred->marked.load(std::memory_order_acquire) &&
+                        (succ == tail_ || !succ->marked.load(std::memory_order_acquire)) &&
+                        pred->next[level].load(std::memory_order_acquire) == succ;
+            }
+            if (!valid)
+            {
+                UnlockPreds(preds, highest_locked);
+                continue;
+            }
+
+            Node *node = new Node(key, value, top_level);
+            for (int level = 0; level <= top_level; ++level)
+            {
+                node->next[level].store(succs[level], std::memory_order_relaxed);
+            }
+            for (int level = 0; level <= top_level; ++level)
+            {
+                preds[level]->next[level].store(node, std::memory_order_release);
+            }
+            node->fully_linked.store(true, std::memory_order_release);
+            UnlockPreds(preds, highest_locked);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Erases @p key if present. Returns false if it was absent.
+     */
+    bool erase(const Key &key)
+    {
+        const EpochGuard pin(*this);
+        Node *victim = nullptr;
+        bool is_marked = false;
+        int top_level = -1;
+        Node *preds[MaxLevel];
+        Node *succs[MaxLevel];
+        while (true)
+        {
+            int found = find(key, preds, succs);
+            if (found != -1)
+            {
+                victim = succs[found];
+            }
+            if (!is_marked && (found == -1 || !victim->fully_linked.load(std::memory_order_acquire) ||
+                               victim->top_level != found || victim->marked.load(std::memory_order_acquire)))
+            {
+                return false;
+            }
+
+            if (!is_marked)
+            {
+                top_level = victim->top_level;
+                victim->lock.lock();
+                if (victim->marked.load(std::memory_order_relaxed))
+                {
+                    victim->lock.unlock();
+                    return false;
+                }
+                // Logical deletion: from here on readers skip the node.
+                victim->marked.store(true, std::memory_order_release);
+                is_marked = true;
+            }
+
+            int highest_locked = -1;
+            bool valid = true;
+            Node *prev_pred = nullptr;
+            for (int level = 0; valid && level <= top_level; ++level)
+            {
+                Node *pred = preds[level];
+                if (pred != prev_pred)
+                {
+                    pred->lock.lock();
+                    prev_pred = pred;
+                }
+                highest_locked = level;
+                valid = !pred->marked.load(std::memory_order_acquire) &&
+                        pred->next[level].load(std::memory_order_acquire) == victim;
+            }
+            if (!valid)
+            {
+                UnlockPreds(preds, highest_locked);
+                continue;
+            }
+
+            for (int level = top_level; level >= 0; --level)
+            {
+                preds[level]->next[level].store(victim->next[level].load(std::memory_order_relaxed),
+                                                std::memory_order_release);
+            }
+            victim->lock.unlock();
+            UnlockPreds(preds, highest_locked);
+            Retire(victim);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Adds @p delta to the value stored under @p key. Returns false if absent.
+     * The update is a CAS loop on the node's value, so no node lock is taken.
+     */
+    bool add(const Key &key, const Value &delta)
+    {
+        const EpochGuard pin(*this);
+        Node *preds[MaxLevel];
+        Node *succs[MaxLevel];
+        int found = find(key, preds, succs);
+        if (found == -1)
+        {
+            return false;
+        }
+        Node *node = succs[found];
+        if (!node->fully_linked.load(std::memory_order_acquire) || node->marked.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        Value expected = node->value.load(std::memory_order_relaxed);
+        while (!node->value.compare_exchange_weak(expected, expected + delta, std::memory_order_acq_rel,
+                                                  std::memory_order_relaxed))
+        {
+        }
+        return true;
+    }
+
+    /**
+     * @brief Lock-free range scan: calls @p fn(key, value) for every live key in [lo, hi).
+     * * The scan is weakly consistent (like java.util.concurrent iterators): it
+     * sees every key present for its whole duration, and may or may not see keys
+     * inserted or erased while it runs.
+     */
+    template <typename Fn>
+    void for_each_in_range(const Key &lo, const Key &hi, Fn &&fn) const
+    {
+        const EpochGuard pin(*this);
+        Node *pred = head_;
+        for (int level = MaxLevel - 1; level >= 0; --level)
+        {
+            Node *curr = pred->next[level].load(std::memory_order_acquire);
+            while (curr != tail_ && curr->key < lo)
+            {
+                pred = curr;
+                curr = pred->next[level].load(std::memory_order_acquire);
+            }
+        }
+        for (Node *node = pred->next[0].load(std::memory_order_acquire); node != tail_ && node->key < hi;
+             node = node->next[0].load(std::memory_order_acquire))
+        {
+            if (node->fully_linked.load(std::memory_order_acquire) && !node->marked.load(std::memory_order_acquire))
+            {
+                fn(node->key, node->value.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+  private:
+    struct Node
+    {
+        Node(const Key &k, const Value &v, int level) : key(k), value(v), top_level(level)
+        {
+            for (int i = 0; i < MaxLevel; ++i)
+            {
+                next[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        const Key key;
+        std::atomic<Value> value;
+        const int top_level;
+        std::atomic<bool> marked{ false };
+        std::atomic<bool> fully_linked{ false };
+        std::mutex lock;
+        Node *retired_next = nullptr;
+        /// @brief The epoch when the node was retired.
+        std::uint64_t retired_epoch = 0;
+        std::atomic<Node *> next[MaxLevel];
+    };
+
+    /**
+     * @brief Fills preds/succs for every level and returns the highest level
+     * at which @p key was found, or -1.
+     */
+    int find(const Key &key, Node **preds, Node **succs) const
+    {
+        int found = -1;
+        Node *pred = head_;
+        for (int level = MaxLevel - 1; level >= 0; --level)
+        {
+            Node *curr = pred->next[level].load(std::memory_order_acquire);
+            while (curr != tail_ && curr->key < key)
+            {
+                pred = curr;
+                curr = pred->next[level].load(std::memory_order_acquire);
+            }
+            if (found == -1 && curr != tail_ && !(key < curr->key))
+            {
+                found = level;
+            }
+            preds[level] = pred;
+            succs[level] = curr;
+        }
+        return found;
+    }
+
+    /**
+     * @brief Releases each distinct predecessor locked at levels [0, highest].
+     */
+    static void UnlockPreds(Node **preds, int highest)
+    {
+        Node *prev_pred = nullptr;
+        for (int level = 0; level <= highest; ++level)
+        {
+            if (preds[level] != prev_pred)
+            {
+                preds[level]->lock.unlock();
+                prev_pred = preds[level];
+            }
+        }
+    }
+
+    /**
+     * @class EpochGuard
+     * @brief Pins the current epoch for one operation, so nothing it may reach is freed until it ends.
+     * The announcement is a seq_cst exchange: a reclaimer that advances the
+     * epoch and then misses it cannot have retired a node this operation sees.
+     */
+    class EpochGuard
+    {
+      public:
+        explicit EpochGuard(const ConcurrentSkipList &list) : list_(list), index_(list.pinners_.Index())
+        {
+            const std::uint64_t epoch = list_.epoch_.load(std::memory_order_seq_cst);
+            if (index_ < kEpochSlots)
+            {
+                list_.pins_[index_].epoch.exchange(epoch, std::memory_order_seq_cst);
+            }
+            else
+            {
+                list_.overflow_pins_.fetch_add(1, std::memory_order_seq_cst);
+            }
+        }
+
+        ~EpochGuard()
+        {
+            if (index_ < kEpochSlots)
+            {
+                list_.pins_[index_].epoch.store(0, std::memory_order_release);
+            }
+            else
+            {
+                list_.overflow_pins_.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        EpochGuard(const EpochGuard &) = delete;
+        EpochGuard &operator=(const EpochGuard &) = delete;
+
+      private:
+        const ConcurrentSkipList &list_;
+        const int index_;
+    };
+
+    /// @brief One thread's pinned epoch, or 0 outside any operation.
+    struct alignas(64) EpochPin
+    {
+        std::atomic<std::uint64_t> epoch{ 0 };
+    };
+
+    void Retire(Node *node)
+    {
+        node->retired_epoch = epoch_.load(std::memory_order_seq_cst);
+        Push(node);
+        if (retired_count_.fetch_add(1, std::memory_order_relaxed) + 1 >= kReclaimBatch)
+        {
+            Reclaim();
+        }
+    }
+
+    void Push(Node *node)
+    {
+        Node *top = retired_.load(std::memory_order_relaxed);
+        do
+        {
+            node->retired_next = top;
+        } while (!retired_.compare_exchange_weak(top, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Advances the epoch and frees every retired node older than the
+     * oldest pinned epoch. One thread at a time; others skip the pass.
+     */
+    void Reclaim()
+    {
+        if (reclaiming_.exchange(true, std::memory_order_acquire))
+        {
+            return;
+        }
+        std::uint64_t safe = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+        if (overflow_pins_.load(std::memory_order_seq_cst) == 0)
+        {
+            for (const EpochPin &pin : pins_)
+            {
+                const std::uint64_t pinned = pin.epoch.load(std::memory_order_seq_cst);
+                if (pinned != 0 && pinned < safe)
+                {
+                    safe = pinned;
+                }
+            }
+            Node *node = retired_.exchange(nullptr, std::memory_order_acquire);
+            int freed = 0;
+            while (node != nullptr)
+            {
+                Node *next = node->retired_next;
+                if (node->retired_epoch < safe)
+                {
+                    delete node;
+                    ++freed;
+                }
+                else
+                {
+                    Push(node);
+                }
+                node = next;
+            }
+            retired_count_.fetch_sub(freed, std::memory_order_relaxed);
+        }
+        reclaiming_.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Geometric tower height (p = 1/2) from a per-thread xorshift generator.
+     */
+    static int RandomLevel()
+    {
+        thread_local std::uint32_t seed = 0x9E3779B9u ^ static_cast<std::uint32_t>(
+                                                            reinterpret_cast<std::uintptr_t>(&seed));
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int level = 0;
+        std::uint32_t bits = seed;
+        while ((bits & 1u) != 0 && level < MaxLevel - 1)
+        {
+            ++level;
+            bits >>= 1;
+        }
+        return level;
+    }
+
+    Node *head_;
+    Node *tail_;
+    std::atomic<Node *> retired_{ nullptr };
+    std::atomic<int> retired_count_{ 0 };
+    std::atomic<bool> reclaiming_{ false };
+    /// @brief Starts at 1, so a pin of 0 means "not in an operation".
+    alignas(64) std::atomic<std::uint64_t> epoch_{ 1 };
+    mutable ClientRegistry pinners_;
+    mutable EpochPin pins_[kEpochSlots];
+    mutable std::atomic<int> overflow_pins_{ 0 };
+};
@@ -0,0 +1,141 @@
+/**
+ * @file cpu_topology.h
+ * @brief Picks CPU pairs by how close they are (SMT siblings, same socket, other socket) and pins threads.
+ * * DESIGN PRINCIPLE:
+ * A lock hand-off is a cache line moving from one core to another, and its
+ * cost is set by the distance: SMT siblings share the L1, cores of one
+ * socket share the L3, and sockets talk over the interconnect. The pairs
+ * come from the sysfs topology of the CPUs this process may run on, so a
+ * taskset or cgroup restriction is respected; a placement the host cannot
+ * offer (no SMT, one socket) is reported as missing, never approximated.
+ */
+
+#pragma once
+
+#include "environment_check.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @enum CpuPlacement
+ * @brief How far apart the two CPUs of a pair are.
+ */
+enum class CpuPlacement
+{
+    kSmt,
+    kCore,
+    kSocket
+};
+
+inline const char *CpuPlacementName(CpuPlacement placement)
+{
+    switch (placement)
+    {
+    case CpuPlacement::kSmt:
+        return "smt";
+    case CpuPlacement::kCore:
+        return "core";
+    case CpuPlacement::kSocket:
+        return "socket";
+    }
+    return "";
+}
+
+/**
+ * @brief Two CPUs this process may run on with the given @p placement, or
+ * nothing if the host has no such pair. The lowest-numbered match is chosen.
+ */
+inline std::optional<std::pair<int, int>> FindCpuPair(CpuPlacement placement)
+{
+    struct Cpu
+    {
+        int id;
+        std::string package;
+        std::string core;
+    };
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+    {
+        return std::nullopt;
+    }
+    std::vector<Cpu> cpus;
+    for (int id = 0; id < CPU_SETSIZE; ++id)
+    {
+        if (!CPU_ISSET(id, &allowed))
+        {
+            continue;
+        }
+        const std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+        Cpu cpu{ id, ReadFirstLine(topology + "physical_package_id"), ReadFirstLine(topology + "core_id") };
+        // Without topology a CPU cannot be placed, so it is left out rather than guessed.
+        if (!cpu.package.empty() && !cpu.core.empty())
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    for (std::size_t i = 0; i < cpus.size(); ++i)
+    {
+        for (std::size_t j = i + 1; j < cpus.size(); ++j)
+        {
+            const bool same_package = cpus[i].package == cpus[j].package;
+            const bool same_core = same_package && cpus[i].core == cpus[j].core;
+            const bool match = placement == CpuPlacement::kSmt    ? same_core
+                               : placement == CpuPlacement::kCore ? same_package && !same_core
+                                                                  : !same_package;
+            if (match)
+            {
+                return std::make_pair(cpus[i].id, cpus[j].id);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @class ScopedCpuPin
+ * @brief Pins the calling thread to one CPU and restores its previous affinity on destruction.
+ * Benchmark thread 0 is the main thread, so leaving it pinned would skew every later benchmark.
+ */
+class ScopedCpuPin
+{
+  public:
+    explicit ScopedCpuPin(int cpu)
+    {
+        CPU_ZERO(&previous_);
+        if (pthread_getaffinity_np(pthread_self(), sizeof(previous_), &previous_) != 0)
+        {
+            return;
+        }
+        cpu_set_t target;
+        CPU_ZERO(&target);
+        CPU_SET(cpu, &target);
+        pinned_ = pthread_setaffinity_np(pthread_self(), sizeof(target), &target) == 0;
+    }
+
+    ~ScopedCpuPin()
+    {
+        if (pinned_)
+        {
+            pthread_setaffinity_np(pthread_self(), sizeof(previous_), &previous_);
+        }
+    }
+
+    ScopedCpuPin(const ScopedCpuPin &) = delete;
+    ScopedCpuPin &operator=(const ScopedCpuPin &) = delete;
+
+    bool pinned() const
+    {
+        return pinned_;
+    }
+
+  private:
+    cpu_set_t previous_;
+    bool pinned_ = false;
+};
@@ -0,0 +1,203 @@
+/**
+ * @file cross_process_bench.cpp
+ * @brief One writer and N-1 readers sharing a table in POSIX shared memory, as threads or as processes.
+ * * DESIGN PRINCIPLE:
+ * Services that share state between worker processes pay for locks that
+ * work across address spaces. Here the table and its lock live in one
+ * shared mapping (shared_table.h): the benchmark thread is the writer, and
+ * the readers are either threads of this process (workers=threads) or
+ * children forked after the mapping was created (workers=processes), so the
+ * two rows differ only in the address-space boundary. The same rwlock kind
+ * without PTHREAD_PROCESS_SHARED (lock=pthread_rwlock_private, thread readers
+ * only) isolates what process sharing costs. Every rwlock here
+ * prefers writers, unlike std::shared_mutex, so the lock=shared_mutex rows
+ * of the lock matrix are not a like-for-like baseline. All workers run the
+ * same reader loop, which keeps its read count current in a slot of the
+ * mapping. Google Benchmark cannot time a forked process, so every row is
+ * one benchmark thread that starts and stops its own readers around the
+ * timed loop and samples the counts right before and after it;
+ * participants=N corresponds to threads:N of the closed-loop benchmarks, and
+ * scripts/usl_fit.py groups the rows into one family per lock and worker kind.
+ */
+
+#include "bench_registry.h"
+#include "shared_table.h"
+#include "suites.h"
+
+#include <benchmark/benchmark.h>
+#include <sys/wait.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/// @brief Upper bound on reader workers of one run.
+constexpr int kMaxWorkers = 64;
+
+/**
+ * @struct CrossProcessRun
+ * @brief Everything the writer and its workers share: the table and the start/stop protocol.
+ */
+template <typename Lock>
+struct CrossProcessRun
+{
+    SharedTable<Lock> table;
+    alignas(64) std::atomic<bool> start{ false };
+    alignas(64) std::atomic<bool> stop{ false };
+    /// @brief Reads of each worker so far, updated after every read.
+    struct alignas(64) Slot
+    {
+        std::atomic<std::int64_t> reads{ 0 };
+    } slots[kMaxWorkers];
+
+    static_assert(std::atomic<std::int64_t>::is_always_lock_free, "shared counters need lock-free atomics");
+};
+
+/**
+ * @brief Reader loop of worker @p slot; the same code runs in a thread and in a forked child.
+ */
+template <typename Lock>
+void RunTableReader(CrossProcessRun<Lock> &run, int slot)
+{
+    SpinWait wait;
+    while (!run.start.load(std::memory_order_acquire))
+    {
+        wait.Once();
+    }
+    std::int64_t reads = 0;
+    while (!run.stop.load(std::memory_order_relaxed))
+    {
+        double total = 0;
+        run.table.lock.read([&] { total = HeavyTableRead(run.table); });
+        benchmark::DoNotOptimize(total);
+        run.slots[slot].reads.store(++reads, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Reads completed so far by workers [0, @p workers).
+ */
+template <typename Lock>
+std::int64_t CountReads(const CrossProcessRun<Lock> &run, int workers)
+{
+    std::int64_t reads = 0;
+    for (int w = 0; w < workers; ++w)
+    {
+        reads += run.slots[w].reads.load(std::memory_order_relaxed);
+    }
+    return reads;
+}
+
+/**
+ * @brief Registers the cross-process closed loop for @p Lock with readers as
+ * threads or as forked processes, at every participant count of ThreadSweep().
+ * A lock that is not process-shared gets thread readers only.
+ */
+template <typename Lock>
+void RegisterCrossProcess(bool processes)
+{
+    if (processes && !Lock::kProcessShared)
+    {
+        return;
+    }
+    for (int participants : ThreadSweep())
+    {
+        BenchName name;
+        name.Add("lock", Lock::kName)
+            .Add("container", "table")
+            .Add("read", "heavy")
+            .Add("write", "update")
+            .Add("load", "closed")
+            .Add("workers", processes ? "processes" : "threads")
+            .Add("participants", participants);
+        benchmark::RegisterBenchmark(name.str().c_str(), [processes, participants](benchmark::State &state) {
+            const int workers = participants - 1;
+            if (workers > kMaxWorkers)
+            {
+                state.SkipWithError("too many participants");
+                return;
+            }
+            SharedMemorySegment<CrossProcessRun<Lock>> segment;
+            CrossProcessRun<Lock> *run = segment.get();
+            if (run == nullptr)
+            {
+                state.SkipWithError("cannot create the shared memory segment");
+                return;
+            }
+            std::vector<std::thread> threads;
+            std::vector<pid_t> children;
+            bool started = true;
+            for (int w = 0; w < workers && started; ++w)
+            {
+                if (!processes)
+                {
+                    threads.emplace_back(RunTableReader<Lock>, std::ref(*run), w);
+                    continue;
+                }
+                const pid_t pid = fork();
+                if (pid == 0)
+                {
+                    RunTableReader(*run, w);
+                    _exit(0);
+                }
+                started = pid > 0;
+                if (started)
+                {
+                    children.push_back(pid);
+                }
+            }
+            // Workers spin on start; once it is raised they read flat out, before and during the timed loop.
+            run->start.store(true, std::memory_order_release);
+            std::int64_t writes = 0;
+            std::int64_t reads = 0;
+            if (started)
+            {
+                // Only reads between the two samples count, so the window is the timed loop.
+                const std::int64_t reads_before = CountReads(*run, workers);
+                for (auto _ : state)
+                {
+                    run->table.lock.write([&] { TableWrite(run->table); }); // 1 Writer
+                    ++writes;
+                }
+                reads = CountReads(*run, workers) - reads_before;
+            }
+            run->stop.store(true, std::memory_order_relaxed);
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+            bool exited = true;
+            for (pid_t child : children)
+            {
+                int status = 0;
+                exited = waitpid(child, &status, 0) == child && WIFEXITED(status) && exited;
+            }
+            if (!started || !exited)
+            {
+                state.SkipWithError("a reader process failed");
+                return;
+            }
+            state.counters["writes"] = benchmark::Counter(static_cast<double>(writes), benchmark::Counter::kIsRate);
+            ReportReads(state, reads, workers);
+        })
+            ->UseRealTime();
+    }
+}
+
+} // namespace
+
+void RegisterCrossProcessBenchmarks()
+{
+    // The in-process baseline first: same rwlock kind, not process-shared.
+    RegisterCrossProcess<PrivatePthreadRwLock>(false);
+    for (bool processes : { false, true })
+    {
+        RegisterCrossProcess<PthreadRwLock>(processes);
+        RegisterCrossProcess<SeqLock>(processes);
+    }
+}
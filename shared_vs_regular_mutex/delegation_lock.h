@@ -0,0 +1,120 @@
+/**
+ * @file delegation_lock.h
+ * @brief Delegation (ffwd, RCL): a dedicated server thread runs every critical section.
+ * * DESIGN PRINCIPLE:
+ * Flat combining still moves the combiner role, and with it the protected
+ * data, between cores. Here one server thread owns the data for the lock's
+ * whole lifetime: clients publish a request in their own cache-line-aligned
+ * mailbox and spin on it until the server has run it and cleared the flag.
+ * The data never leaves the server's cache, and the only lines that move
+ * are the mailboxes. The price is a core spent on the server and a round
+ * trip on every operation, even an uncontended one.
+ */
+
+#pragma once
+
+#include "client_slots.h"
+#include "spin_wait.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @class DelegationLock
+ * @brief Lock policy (see lock_policies.h) that ships critical sections to a server thread.
+ * Client threads beyond kMaxClients share one extra mailbox, taken in turn under a mutex.
+ */
+class DelegationLock
+{
+  public:
+    static constexpr const char *kName = "delegation";
+
+    /// @brief Mailboxes of their own; later client threads share the overflow mailbox.
+    static constexpr int kMaxClients = 64;
+
+    DelegationLock() : server_([this] { Serve(); })
+    {
+    }
+
+    ~DelegationLock()
+    {
+        stop_.store(true, std::memory_order_release);
+        server_.join();
+    }
+
+    DelegationLock(const DelegationLock &) = delete;
+    DelegationLock &operator=(const DelegationLock &) = delete;
+
+    template <typename Fn>
+    void read(Fn &&fn)
+    {
+        Delegate<std::remove_reference_t<Fn>>(fn);
+    }
+
+    template <typename Fn>
+    void write(Fn &&fn)
+    {
+        Delegate<std::remove_reference_t<Fn>>(fn);
+    }
+
+  private:
+    template <typename Fn>
+    void Delegate(Fn &fn)
+    {
+        const int index = clients_.Index();
+        if (index >= kMaxClients)
+        {
+            std::lock_guard<std::mutex> lock(overflow_mtx_);
+            Call(mailboxes_[kMaxClients], fn);
+            return;
+        }
+        Call(mailboxes_[index], fn);
+    }
+
+    template <typename Fn>
+    static void Call(PublishedOp &mailbox, Fn &fn)
+    {
+        mailbox.Publish(fn);
+        SpinWait wait;
+        while (mailbox.pending.load(std::memory_order_acquire))
+        {
+            wait.Once();
+        }
+    }
+
+    /**
+     * @brief Server loop: sweeps the mailboxes in use until the lock is destroyed.
+     * No client is waiting at destruction, since each one returns only after its reply.
+     */
+    void Serve()
+    {
+        SpinWait idle;
+        while (!stop_.load(std::memory_order_acquire))
+        {
+            const int used = clients_.Used();
+            const int mailboxes = used < kMaxClients ? used : kMaxClients + 1;
+            bool served = false;
+            for (int i = 0; i < mailboxes; ++i)
+            {
+                served |= mailboxes_[i].RunIfPending();
+            }
+            if (served)
+            {
+                idle = SpinWait();
+            }
+            else
+            {
+                idle.Once();
+            }
+        }
+    }
+
+    ClientRegistry clients_;
+    PublishedOp mailboxes_[kMaxClients + 1];
+    std::mutex overflow_mtx_;
+    alignas(64) std::atomic<bool> stop_{ false };
+    /// @brief Declared last: it starts serving once every other member is constructed.
+    std::thread server_;
+};
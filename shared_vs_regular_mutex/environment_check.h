@@ -0,0 +1,269 @@
+/**
+ * @file environment_check.h
+ * @brief Records the host settings that make lock benchmarks irreproducible, and warns about them.
+ * * DESIGN PRINCIPLE:
+ * Lock hand-offs are a few hundred cycles, so a frequency ramp, a turbo
+ * bin, an SMT sibling or a co-tenant thread moves the numbers more than
+ * the lock under test does. Before the run, every setting is read from
+ * /proc and /sys, added to the JSON "context" as env_* keys so
+ * results from different hosts can be told apart, and each one that is
+ * known to add noise is printed as a warning. Settings the kernel does not
+ * expose (e.g. cpufreq inside most VMs) are recorded as "unavailable".
+ * The CPU model, kernel release and libc version are recorded too, without
+ * the env_ prefix, so a saved JSON file says which system produced it.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <sys/utsname.h>
+
+#if defined(__GLIBC__)
+#include <gnu/libc-version.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief 1-minute load average above which another process is assumed to be competing for CPUs.
+inline constexpr double kMaxIdleLoadAverage = 1.0;
+
+/**
+ * @struct EnvironmentReport
+ * @brief The recorded settings, in order, and the warnings they raised.
+ */
+struct EnvironmentReport
+{
+    std::vector<std::pair<std::string, std::string>> settings;
+    std::vector<std::string> warnings;
+};
+
+/**
+ * @brief First line of @p path without the trailing newline, or "" if it cannot be read.
+ */
+inline std::string ReadFirstLine(const std::string &path)
+{
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+/**
+ * @brief The bracketed choice of a sysfs selector such as "always [madvise] never".
+ */
+inline std::string SelectedOption(const std::string &line)
+{
+    const auto open = line.find('[');
+    const auto close = line.find(']', open);
+    if (open == std::string::npos || close == std::string::npos)
+    {
+        return line;
+    }
+    return line.substr(open + 1, close - open - 1);
+}
+
+/**
+ * @brief Distinct scaling governors across all CPUs, comma separated.
+ */
+inline std::string ScalingGovernors()
+{
+    std::set<std::string> governors;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator("/sys/devices/system/cpu", error))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > 3 && name.compare(0, 3, "cpu") == 0 && std::isdigit(static_cast<unsigned char>(name[3])))
+        {
+            const std::string governor = ReadFirstLine(entry.path().string() + "/cpufreq/scaling_governor");
+            if (!governor.empty())
+            {
+                governors.insert(governor);
+            }
+        }
+    }
+    std::string joined;
+    for (const std::string &governor : governors)
+    {
+        joined += (joined.empty() ? "" : ",") + governor;
+    }
+    return joined;
+}
+
+/**
+ * @brief "on", "off" or "" for turbo/boost, from intel_pstate or the generic cpufreq knob.
+ */
+inline std::string TurboState()
+{
+    const std::string no_turbo = ReadFirstLine("/sys/devices/system/cpu/intel_pstate/no_turbo");
+    if (!no_turbo.empty())
+    {
+        return no_turbo == "0" ? "on" : "off";
+    }
+    const std::string boost = ReadFirstLine("/sys/devices/system/cpu/cpufreq/boost");
+    if (!boost.empty())
+    {
+        return boost == "1" ? "on" : "off";
+    }
+    return "";
+}
+
+/**
+ * @brief "model name" of the first CPU in /proc/cpuinfo, or "".
+ */
+inline std::string CpuModel()
+{
+    std::ifstream in("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.compare(0, 10, "model name") == 0)
+        {
+            const auto colon = line.find(':');
+            const auto start = line.find_first_not_of(" \t", colon + 1);
+            return colon == std::string::npos || start == std::string::npos ? "" : line.substr(start);
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief cpu_model, kernel and libc of this host, in the format scripts/bench_baseline.py stores.
+ */
+inline std::vector<std::pair<std::string, std::string>> HostIdentity()
+{
+    std::vector<std::pair<std::string, std::string>> identity;
+    const std::string cpu_model = CpuModel();
+    identity.emplace_back("cpu_model", cpu_model.empty() ? "unknown" : cpu_model);
+    utsname name{};
+    identity.emplace_back("kernel", uname(&name) == 0 ? name.release : "unknown");
+#if defined(__GLIBC__)
+    identity.emplace_back("libc", std::string("glibc ") + gnu_get_libc_version());
+#else
+    identity.emplace_back("libc", "unknown");
+#endif
+    return identity;
+}
+
+/**
+ * @brief Reads every setting and decides which ones to warn about.
+ */
+inline EnvironmentReport CheckEnvironment()
+{
+    EnvironmentReport report;
+    const auto record = [&report](const std::string &key, const std::string &value) {
+        report.settings.emplace_back(key, value.empty() ? "unavailable" : value);
+    };
+
+    const std::string governors = ScalingGovernors();
+    record("env_governor", governors);
+    if (!governors.empty() && governors != "performance")
+    {
+        report.warnings.push_back("CPU frequency governor is '" + governors +
+                                  "'; use 'performance' so cores do not ramp during the run");
+    }
+
+    const std::string turbo = TurboState();
+    record("env_turbo", turbo);
+    if (turbo == "on")
+    {
+        report.warnings.push_back("turbo boost is on; clock speed will depend on temperature and active cores");
+    }
+
+    const std::string smt = ReadFirstLine("/sys/devices/system/cpu/smt/active");
+    record("env_smt", smt.empty() ? "" : (smt == "1" ? "on" : "off"));
+    if (smt == "1")
+    {
+        report.warnings.push_back("SMT is active; benchmark threads may share a physical core");
+    }
+
+    // An empty list means no isolated CPUs; a missing file means the kernel does not say.
+    const std::string isolated_path = "/sys/devices/system/cpu/isolated";
+    const bool isolated_known = static_cast<bool>(std::ifstream(isolated_path));
+    const std::string isolated = ReadFirstLine(isolated_path);
+    record("env_isolated_cpus", isolated_known && isolated.empty() ? "none" : isolated);
+    if (isolated_known && isolated.empty())
+    {
+        report.warnings.push_back("no isolated CPUs (isolcpus); other tasks may be scheduled on benchmark cores");
+    }
+
+    const std::string loadavg = ReadFirstLine("/proc/loadavg");
+    const std::string load_1m = loadavg.substr(0, loadavg.find(' '));
+    record("env_loadavg_1m", load_1m);
+    if (!load_1m.empty() && std::stod(load_1m) > kMaxIdleLoadAverage)
+    {
+        report.warnings.push_back("1-minute load average is " + load_1m + "; other processes are competing for CPUs");
+    }
+
+    const std::string thp = SelectedOption(ReadFirstLine("/sys/kernel/mm/transparent_hugepage/enabled"));
+    record("env_thp", thp);
+    if (thp == "always")
+    {
+        report.warnings.push_back("transparent hugepages are 'always'; khugepaged compaction can stall allocations");
+    }
+    return report;
+}
+
+/**
+ * @brief True if the command line has --benchmark_list_tests set, in which
+ * case nothing runs and the environment is not worth reporting. Reads the
+ * value as Google Benchmark does; call before benchmark::Initialize consumes it.
+ */
+inline bool ListsTestsOnly(int argc, char **argv)
+{
+    static const char kFlag[] = "--benchmark_list_tests";
+    bool listing = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], kFlag, sizeof(kFlag) - 1) != 0)
+        {
+            continue;
+        }
+        const char *rest = argv[i] + sizeof(kFlag) - 1;
+        if (*rest == '\0')
+        {
+            listing = true;
+            continue;
+        }
+        if (*rest != '=')
+        {
+            continue;
+        }
+        std::string value(rest + 1);
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        listing = value.empty() || !(value == "0" || value == "f" || value == "n" || value == "false" ||
+                                     value == "no" || value == "off");
+    }
+    return listing;
+}
+
+/**
+ * @brief Adds the host identity and the settings to the benchmark context and
+ * prints the warnings to stderr. Call after benchmark::Initialize and before
+ * RunSpecifiedBenchmarks.
+ */
+inline void RecordEnvironment()
+{
+    for (const auto &[key, value] : HostIdentity())
+    {
+        benchmark::AddCustomContext(key, value);
+    }
+    const EnvironmentReport report = CheckEnvironment();
+    for (const auto &[key, value] : report.settings)
+    {
+        benchmark::AddCustomContext(key, value);
+    }
+    for (const std::string &warning : report.warnings)
+    {
+        std::fprintf(stderr, "***WARNING*** %s\n", warning.c_str());
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * @file flat_combining_lock.h
+ * @brief Flat combining (Hendler et al.): one thread runs everyone's critical sections.
+ * * DESIGN PRINCIPLE:
+ * With a plain mutex every critical section pays a lock hand-off, and the
+ * protected data migrates to each new owner's cache. Here a thread publishes
+ * its critical section in its own cache-line-aligned slot and then tries to
+ * become the combiner. The combiner walks all slots and runs every pending
+ * operation back to back, so the data stays hot in one core's cache and one
+ * lock acquisition covers a whole batch. Threads that lose the race spin on
+ * their own slot, never on the shared lock word, until the combiner marks
+ * the operation done. Reads and writes are combined alike: all operations
+ * are serialized, and the win is in the hand-off, not in read parallelism.
+ */
+
+#pragma once
+
+#include "client_slots.h"
+#include "spin_wait.h"
+
+#include <atomic>
+#include <type_traits>
+
+/**
+ * @class FlatCombiningLock
+ * @brief Lock policy (see lock_policies.h) that executes critical sections by combining.
+ * With more than kMaxSlots client threads the extra ones take the combiner lock directly.
+ */
+class FlatCombiningLock
+{
+  public:
+    static constexpr const char *kName = "flat_combining";
+
+    /// @brief Publication slots; more client threads than this bypass combining.
+    static constexpr int kMaxSlots = 64;
+
+    /// @brief Scans of the slot array per combining session.
+    static constexpr int kCombiningPasses = 2;
+
+    template <typename Fn>
+    void read(Fn &&fn)
+    {
+        Execute<std::remove_reference_t<Fn>>(fn);
+    }
+
+    template <typename Fn>
+    void write(Fn &&fn)
+    {
+        Execute<std::remove_reference_t<Fn>>(fn);
+    }
+
+  private:
+    template <typename Fn>
+    void Execute(Fn &fn)
+    {
+        const int index = clients_.Index();
+        SpinWait wait;
+        if (index >= kMaxSlots)
+        {
+            while (!TryAcquire())
+            {
+                wait.Once();
+            }
+            fn();
+            combiner_.store(false, std::memory_order_release);
+            return;
+        }
+        PublishedOp &slot = slots_[index];
+        slot.Publish(fn);
+        while (slot.pending.load(std::memory_order_acquire))
+        {
+            if (TryAcquire())
+            {
+                Combine();
+                combiner_.store(false, std::memory_order_release);
+            }
+            else
+            {
+                wait.Once();
+            }
+        }
+    }
+
+    bool TryAcquire()
+    {
+        return !combiner_.load(std::memory_order_relaxed) && !combiner_.exchange(true, std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Runs every published operation. Our own slot was published before
+     * we became combiner, so the first pass always serves it.
+     */
+    void Combine()
+    {
+        const int used = clients_.Used();
+        const int slots = used < kMaxSlots ? used : kMaxSlots;
+        for (int pass = 0; pass < kCombiningPasses; ++pass)
+        {
+            for (int i = 0; i < slots; ++i)
+            {
+                slots_[i].RunIfPending();
+            }
+        }
+    }
+
+    /// @brief The combiner role; only the thread holding it touches the protected data.
+    alignas(64) std::atomic<bool> combiner_{ false };
+    ClientRegistry clients_;
+    PublishedOp slots_[kMaxSlots];
+};
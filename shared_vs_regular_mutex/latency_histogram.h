@@ -0,0 +1,146 @@
+/**
+ * @file latency_histogram.h
+ * @brief Fixed-size log-linear latency histogram (HdrHistogram-style), no allocation.
+ * * DESIGN PRINCIPLE:
+ * Values below 64 ns are counted exactly; above that every power of two is
+ * split into 32 linear sub-buckets, so any recorded value is reported within
+ * ~3% of its true value. Recording is a shift, a count-leading-zeros and an
+ * increment, cheap enough to sit next to a lock acquisition. Each thread owns
+ * one histogram; they are merged only after the timed loop.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class LatencyHistogram
+ * @brief Counts nanosecond latencies in log-linear buckets covering [0, 2^64).
+ */
+class LatencyHistogram
+{
+  public:
+    /// @brief Sub-buckets per power of two, as a bit count.
+    static constexpr int kSubBucketBits = 5;
+    static constexpr std::uint64_t kSubBuckets = 1ull << kSubBucketBits;
+    static constexpr std::size_t kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    /**
+     * @brief Records one latency of @p ns nanoseconds.
+     */
+    void Record(std::uint64_t ns)
+    {
+        ++counts_[BucketIndex(ns)];
+        ++count_;
+        sum_ += ns;
+        max_ = std::max(max_, ns);
+    }
+
+    /**
+     * @brief Adds every sample of @p other into this histogram.
+     */
+    void Merge(const LatencyHistogram &other)
+    {
+        for (std::size_t i = 0; i < kNumBuckets; ++i)
+        {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    /**
+     * @brief Discards all samples.
+     */
+    void Reset()
+    {
+        counts_.fill(0);
+        count_ = 0;
+        sum_ = 0;
+        max_ = 0;
+    }
+
+    std::uint64_t Count() const
+    {
+        return count_;
+    }
+
+    std::uint64_t Max() const
+    {
+        return max_;
+    }
+
+    double Mean() const
+    {
+        return count_ == 0 ? 0.0 : static_cast<double>(sum_) / static_cast<double>(count_);
+    }
+
+    /**
+     * @brief Value at percentile @p p (0-100): the upper edge of the bucket
+     * holding that rank, capped at the largest recorded value.
+     */
+    std::uint64_t Percentile(double p) const
+    {
+        if (count_ == 0)
+        {
+            return 0;
+        }
+        const auto rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(count_ - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kNumBuckets; ++i)
+        {
+            seen += counts_[i];
+            if (seen >= rank)
+            {
+                return std::min(BucketUpperEdge(i), max_);
+            }
+        }
+        return max_;
+    }
+
+  private:
+    static std::size_t BucketIndex(std::uint64_t ns)
+    {
+        if (ns < 2 * kSubBuckets)
+        {
+            return static_cast<std::size_t>(ns);
+        }
+        const int msb = 63 - __builtin_clzll(ns);
+        const int shift = msb - kSubBucketBits;
+        return static_cast<std::size_t>((shift + 1) * kSubBuckets + ((ns >> shift) - kSubBuckets));
+    }
+
+    static std::uint64_t BucketUpperEdge(std::size_t index)
+    {
+        if (index < 2 * kSubBuckets)
+        {
+            return index;
+        }
+        const int shift = static_cast<int>(index / kSubBuckets) - 1;
+        const std::uint64_t sub = index % kSubBuckets + kSubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    std::array<std::uint64_t, kNumBuckets> counts_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t max_ = 0;
+};
+
+/**
+ * @brief Publishes p50/p99/p99.9/max of @p hist as user counters named "<prefix>_p50" etc.
+ * Call from one thread only: counters are summed across threads.
+ */
+inline void ReportLatency(benchmark::State &state, const LatencyHistogram &hist, const std::string &prefix)
+{
+    state.counters[prefix + "_p50"] = static_cast<double>(hist.Percentile(50.0));
+    state.counters[prefix + "_p99"] = static_cast<double>(hist.Percentile(99.0));
+    state.counters[prefix + "_p999"] = static_cast<double>(hist.Percentile(99.9));
+    state.counters[prefix + "_max"] = static_cast<double>(hist.Max());
+}
@@ -0,0 +1,161 @@
+/**
+ * @file lock_handoff_bench.cpp
+ * @brief Unlock-to-next-acquire hand-off latency between two threads, by CPU distance.
+ * * DESIGN PRINCIPLE:
+ * In the mixed benchmarks a hand-off is hidden inside critical-section work
+ * and contention from many threads. Here exactly two threads take one lock
+ * in strict alternation and do nothing else. The holder raises an atomic
+ * outside the lock to say it is in; the other thread sees it, announces
+ * itself and blocks in write(). The holder waits for that announcement,
+ * gives the waiter a moment to reach the lock, stamps the time and
+ * releases; the waiter stamps again as soon as it is in. The difference,
+ * on the TSC, is the hand-off latency: the wake-up and the lock word and
+ * data moving between caches. The pair is pinned to SMT siblings, two
+ * cores of one socket or two sockets (cpus=smt|core|socket), so that cost
+ * is measured at each distance; cpus=any leaves placement to the scheduler
+ * for hosts that offer no pairs. Only the policies that run the critical
+ * section on the calling thread are measured: under flat combining or
+ * delegation another thread would take both stamps, and a combiner running
+ * its peer's critical section would wait for an announcement from itself.
+ */
+
+#include "bench_registry.h"
+#include "cpu_topology.h"
+#include "latency_histogram.h"
+#include "lock_policies.h"
+#include "lock_profiler.h"
+#include "spin_wait.h"
+#include "suites.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace
+{
+
+/// @brief How long the holder keeps the lock after the waiter announced itself, so it is blocked in write().
+constexpr std::uint64_t kWaiterSettleNs = 2000;
+
+/**
+ * @struct HandoffContext
+ * @brief The lock, the hand-off signals around it, and each thread's hand-off latencies.
+ */
+template <typename Lock>
+struct HandoffContext
+{
+    Lock lock;
+    /// @brief Thread that holds, or last held, the lock; raised from inside the critical section.
+    alignas(64) std::atomic<int> holder{ -1 };
+    /// @brief Thread that is about to block in write() behind the holder.
+    alignas(64) std::atomic<int> waiter{ -1 };
+    /// @brief When the previous holder released the lock (TSC); guarded by lock.
+    std::uint64_t released_at = 0;
+    /// @brief Hand-offs received by thread 0 and thread 1, in ns; each thread writes its own.
+    LatencyHistogram received[2];
+
+    void setup()
+    {
+    }
+};
+
+/**
+ * @brief Registers the hand-off for @p Lock with both threads pinned per
+ * @p placement, or unpinned if it is empty. @p cpus is found once, at
+ * registration; without one the benchmark is skipped.
+ */
+template <typename Lock>
+void RegisterHandoff(const char *placement, std::optional<std::pair<int, int>> cpus)
+{
+    BenchName name;
+    name.Add("lock", Lock::kName).Add("load", "handoff").Add("cpus", placement ? placement : "any");
+    RegisterWithContext<HandoffContext<Lock>>(name, [placement, cpus](benchmark::State &state,
+                                                                      HandoffContext<Lock> &ctx) {
+        if (placement != nullptr && !cpus)
+        {
+            state.SkipWithError((std::string("no ") + placement + " CPU pair on this host").c_str());
+            return;
+        }
+        const int me = state.thread_index();
+        const int other = 1 - me;
+        std::optional<ScopedCpuPin> pin;
+        if (cpus)
+        {
+            pin.emplace(me == 0 ? cpus->first : cpus->second);
+        }
+        const double ns_per_tick = NsPerTsc();
+        const auto settle_ticks = static_cast<std::uint64_t>(static_cast<double>(kWaiterSettleNs) / ns_per_tick);
+        LatencyHistogram &received = ctx.received[me];
+        // Thread 0 takes the lock first; each thread then acquires once per iteration.
+        bool first = me == 0;
+        std::int64_t remaining = static_cast<std::int64_t>(state.max_iterations);
+        for (auto _ : state)
+        {
+            SpinWait wait;
+            if (!first)
+            {
+                while (ctx.holder.load(std::memory_order_acquire) != other)
+                {
+                    wait.Once();
+                }
+                ctx.waiter.store(me, std::memory_order_release);
+            }
+            first = false;
+            // Thread 1's last acquisition is the last of the run: nobody follows it.
+            const bool followed = me == 0 || --remaining > 0;
+            ctx.lock.write([&] {
+                const std::uint64_t entered = ReadTsc();
+                if (ctx.released_at != 0 && entered > ctx.released_at)
+                {
+                    received.Record(
+                        static_cast<std::uint64_t>(static_cast<double>(entered - ctx.released_at) * ns_per_tick));
+                }
+                ctx.holder.store(me, std::memory_order_release);
+                if (followed)
+                {
+                    SpinWait announced;
+                    while (ctx.waiter.load(std::memory_order_acquire) != other)
+                    {
+                        announced.Once();
+                    }
+                    SpinWait settle;
+                    const std::uint64_t until = ReadTsc() + settle_ticks;
+                    while (ReadTsc() < until)
+                    {
+                        settle.Once();
+                    }
+                }
+                ctx.released_at = ReadTsc();
+            });
+        }
+        state.counters["pinned"] = benchmark::Counter(pin && pin->pinned() ? 1 : 0, benchmark::Counter::kAvgThreads);
+        // The timed loop ends on a barrier, so the other thread has stopped recording.
+        if (me == 0)
+        {
+            LatencyHistogram handoff;
+            handoff.Merge(ctx.received[0]);
+            handoff.Merge(ctx.received[1]);
+            ReportLatency(state, handoff, "handoff");
+        }
+    })
+        ->Threads(2)
+        ->UseRealTime();
+}
+
+} // namespace
+
+void RegisterHandoffBenchmarks()
+{
+    CallerThreadLockPolicies::ForEach([](auto tag) {
+        using Lock = typename decltype(tag)::type;
+        for (CpuPlacement placement : { CpuPlacement::kSmt, CpuPlacement::kCore, CpuPlacement::kSocket })
+        {
+            RegisterHandoff<Lock>(CpuPlacementName(placement), FindCpuPair(placement));
+        }
+        RegisterHandoff<Lock>(nullptr, std::nullopt);
+    });
+}
@@ -0,0 +1,159 @@
+/**
+ * @file lock_policies.h
+ * @brief The ways a benchmark can protect shared data, behind one interface.
+ * * DESIGN PRINCIPLE:
+ * A policy runs the critical section for the caller instead of handing out
+ * lock()/unlock(): read(fn) runs fn with at least shared protection and
+ * write(fn) runs it with exclusive protection. Plain locks are then a
+ * guard around fn, and policies that run fn elsewhere (a combiner or a
+ * server thread) fit the same benchmarks. kName is the lock=<kName>
+ * dimension of every benchmark name; a policy listed in AllLockPolicies
+ * is registered in every matrix that iterates it.
+ */
+
+#pragma once
+
+#include "delegation_lock.h"
+#include "flat_combining_lock.h"
+#include "upgrade_mutex.h"
+
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @class MutexLock
+ * @brief std::mutex: readers and the writer are all serialized (pessimistic).
+ */
+class MutexLock
+{
+  public:
+    static constexpr const char *kName = "mutex";
+
+    template <typename Fn>
+    void read(Fn &&fn)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        fn();
+    }
+
+    template <typename Fn>
+    void write(Fn &&fn)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        fn();
+    }
+
+  private:
+    /// @brief On its own cache line, so the protected data never shares it (false sharing).
+    alignas(64) std::mutex mtx_;
+};
+
+/**
+ * @class SharedMutexLock
+ * @brief std::shared_mutex: readers run in parallel while the writer is idle (optimistic).
+ */
+class SharedMutexLock
+{
+  public:
+    static constexpr const char *kName = "shared_mutex";
+
+    template <typename Fn>
+    void read(Fn &&fn)
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx_);
+        fn();
+    }
+
+    template <typename Fn>
+    void write(Fn &&fn)
+    {
+        std::unique_lock<std::shared_mutex> lock(mtx_);
+        fn();
+    }
+
+  private:
+    alignas(64) std::shared_mutex mtx_;
+};
+
+/**
+ * @class UpgradeMutexLock
+ * @brief UpgradeMutex: a shared_mutex that can also turn a read into a write in place.
+ * upgrade(check, update) runs check() with upgrade ownership and, if it
+ * returns true, update() with exclusive ownership, with no writer between them.
+ */
+class UpgradeMutexLock
+{
+  public:
+    static constexpr const char *kName = "upgrade_mutex";
+
+    template <typename Fn>
+    void read(Fn &&fn)
+    {
+        std::shared_lock<UpgradeMutex> lock(mtx_);
+        fn();
+    }
+
+    template <typename Fn>
+    void write(Fn &&fn)
+    {
+        std::unique_lock<UpgradeMutex> lock(mtx_);
+        fn();
+    }
+
+    template <typename Check, typename Update>
+    void upgrade(Check &&check, Update &&update)
+    {
+        UpgradeLock upgradable(mtx_);
+        if (!check())
+        {
+            return;
+        }
+        std::unique_lock<UpgradeMutex> lock = upgradable.Upgrade();
+        update();
+    }
+
+  private:
+    alignas(64) UpgradeMutex mtx_;
+};
+
+/// @brief True for policies with an upgrade(check, update) member.
+template <typename Lock, typename = void>
+struct SupportsUpgrade : std::false_type
+{
+};
+
+template <typename Lock>
+struct SupportsUpgrade<Lock, std::void_t<decltype(std::declval<Lock &>().upgrade(std::declval<bool (&)()>(),
+                                                                                  std::declval<void (&)()>()))>>
+    : std::true_type
+{
+};
+
+/// @brief Type tag passed to PolicyList::ForEach callbacks.
+template <typename Policy>
+struct PolicyTag
+{
+    using type = Policy;
+};
+
+/**
+ * @struct PolicyList
+ * @brief Compile-time list of policies; ForEach(fn) calls fn(PolicyTag<P>{}) for each, in order.
+ */
+template <typename... Policies>
+struct PolicyList
+{
+    template <typename Fn>
+    static void ForEach(Fn &&fn)
+    {
+        (fn(PolicyTag<Policies>{}), ...);
+    }
+};
+
+/// @brief Every lock policy the comparison matrices are registered for.
+using AllLockPolicies = PolicyList<MutexLock, SharedMutexLock, UpgradeMutexLock, FlatCombiningLock, DelegationLock>;
+
+/// @brief The policies that run every critical section on the thread that called read() or write().
+using CallerThreadLockPolicies = PolicyList<MutexLock, SharedMutexLock, UpgradeMutexLock>;
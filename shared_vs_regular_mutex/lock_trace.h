@@ -0,0 +1,252 @@
+/**
+ * @file lock_trace.h
+ * @brief Per-thread lock event rings, exported as Chrome Trace Event JSON.
+ * * DESIGN PRINCIPLE:
+ * A throughput table says the writer is starved; a timeline shows it
+ * waiting behind a convoy of readers. With --lock_bench_trace=FILE every
+ * thread of a traced benchmark records each acquisition (call, enter and
+ * leave timestamps) into its own fixed-size ring, overwriting the oldest
+ * events, so tracing never allocates or synchronizes in the timed loop and
+ * keeps the last kTraceEventsPerThread acquisitions of every thread. After
+ * each run thread 0 converts the rings into "wait" and "hold" slices; the
+ * file, loadable in chrome://tracing or ui.perfetto.dev, is written at exit
+ * with one process per benchmark. Google Benchmark runs a benchmark several
+ * times while it sizes the iteration count; only the last run is kept.
+ * Use a narrow --benchmark_filter: each traced benchmark adds megabytes.
+ */
+
+#pragma once
+
+#include "lock_profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Acquisitions kept per thread; older ones are overwritten.
+constexpr std::size_t kTraceEventsPerThread = 8192;
+
+/// @brief Upper bound on benchmark threads that can be traced.
+constexpr int kMaxTraceThreads = 64;
+
+/**
+ * @struct LockEvent
+ * @brief One acquisition in TSC ticks: when it was requested, entered and left.
+ */
+struct LockEvent
+{
+    std::uint64_t called;
+    std::uint64_t entered;
+    std::uint64_t left;
+    bool exclusive;
+};
+
+/**
+ * @class TraceRing
+ * @brief One thread's most recent LockEvents; an InstrumentedLock sink.
+ */
+class TraceRing
+{
+  public:
+    /**
+     * @brief Empties the ring; allocates it on the first call, by the owning thread.
+     */
+    void Reset()
+    {
+        events_.resize(kTraceEventsPerThread);
+        next_ = 0;
+        wrapped_ = false;
+    }
+
+    void Record(bool exclusive, std::uint64_t called, std::uint64_t entered, std::uint64_t left)
+    {
+        events_[next_] = LockEvent{ called, entered, left, exclusive };
+        if (++next_ == events_.size())
+        {
+            next_ = 0;
+            wrapped_ = true;
+        }
+    }
+
+    /**
+     * @brief Calls fn(event) for every recorded event, oldest first.
+     */
+    template <typename Fn>
+    void ForEach(Fn &&fn) const
+    {
+        if (wrapped_)
+        {
+            for (std::size_t i = next_; i < events_.size(); ++i)
+            {
+                fn(events_[i]);
+            }
+        }
+        for (std::size_t i = 0; i < next_; ++i)
+        {
+            fn(events_[i]);
+        }
+    }
+
+  private:
+    std::vector<LockEvent> events_;
+    std::size_t next_ = 0;
+    bool wrapped_ = false;
+};
+
+/// @brief Wraps a policy so that every acquisition lands in one thread's TraceRing.
+template <typename Lock>
+using TracedLock = InstrumentedLock<Lock, TraceRing>;
+
+/**
+ * @class LockTrace
+ * @brief The trace of this process: the rings of the current run and the
+ * JSON of every finished one. Enabled by --lock_bench_trace.
+ */
+class LockTrace
+{
+  public:
+    bool Enabled() const
+    {
+        return !path_.empty();
+    }
+
+    void Enable(const std::string &path)
+    {
+        path_ = path;
+        rings_.resize(kMaxTraceThreads);
+    }
+
+    /// @brief Ring of benchmark thread @p thread; only that thread may record into it.
+    TraceRing &Ring(int thread)
+    {
+        return rings_[static_cast<std::size_t>(thread)];
+    }
+
+    /**
+     * @brief Converts the rings of threads [0, @p threads) into trace events of
+     * benchmark @p name, replacing any earlier run of it. Call from thread 0
+     * once every thread has left the timed loop. Times start at the run's
+     * first recorded event; a thread that got through fewer acquisitions (a
+     * starved writer) has a ring reaching further back than the others.
+     */
+    void Collect(const std::string &name, int threads)
+    {
+        std::uint64_t origin = std::numeric_limits<std::uint64_t>::max();
+        for (int t = 0; t < threads; ++t)
+        {
+            rings_[t].ForEach([&](const LockEvent &event) { origin = std::min(origin, event.called); });
+        }
+        auto run = std::find_if(runs_.begin(), runs_.end(), [&](const auto &entry) { return entry.first == name; });
+        if (run == runs_.end())
+        {
+            run = runs_.insert(runs_.end(), { name, std::string() });
+        }
+        const int pid = static_cast<int>(run - runs_.begin()) + 1;
+        std::string &json = run->second;
+        json.clear();
+        AppendMetadata(json, pid, 0, "process_name", name);
+        for (int t = 0; t < threads; ++t)
+        {
+            AppendMetadata(json, pid, t, "thread_name", "thread " + std::to_string(t));
+            rings_[t].ForEach([&](const LockEvent &event) {
+                const char *kind = event.exclusive ? "write" : "read";
+                AppendSlice(json, pid, t, std::string(kind) + " wait", event.called - origin, event.entered - origin);
+                AppendSlice(json, pid, t, std::string(kind) + " hold", event.entered - origin, event.left - origin);
+            });
+        }
+    }
+
+    /**
+     * @brief Writes every collected run to the --lock_bench_trace file. Returns false on I/O errors.
+     */
+    bool Write() const
+    {
+        std::FILE *out = std::fopen(path_.c_str(), "w");
+        if (out == nullptr)
+        {
+            return false;
+        }
+        std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", out);
+        bool first = true;
+        for (const auto &run : runs_)
+        {
+            if (run.second.empty())
+            {
+                continue;
+            }
+            if (!first)
+            {
+                std::fputc(',', out);
+            }
+            // Every event ends with a comma; drop the run's last one.
+            std::fwrite(run.second.data(), 1, run.second.size() - 1, out);
+            first = false;
+        }
+        std::fputs("]}\n", out);
+        return std::fclose(out) == 0;
+    }
+
+  private:
+    static void AppendMetadata(std::string &json, int pid, int tid, const char *what, const std::string &name)
+    {
+        json += "{\"ph\":\"M\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid) + ",\"name\":\"" +
+                what + "\",\"args\":{\"name\":\"" + name + "\"}},";
+    }
+
+    /// @brief A complete ("X") slice from tick @p begin to tick @p end, in microseconds.
+    static void AppendSlice(std::string &json, int pid, int tid, const std::string &name, std::uint64_t begin,
+                            std::uint64_t end)
+    {
+        const double us_per_tick = NsPerTsc() / 1000.0;
+        const std::uint64_t duration = end > begin ? end - begin : 0;
+        char buffer[192];
+        std::snprintf(buffer, sizeof(buffer),
+                      "{\"ph\":\"X\",\"cat\":\"lock\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f},",
+                      pid, tid, name.c_str(), static_cast<double>(begin) * us_per_tick,
+                      static_cast<double>(duration) * us_per_tick);
+        json += buffer;
+    }
+
+    std::string path_;
+    std::vector<TraceRing> rings_;
+    /// @brief (benchmark name, its events) in the order the benchmarks first ran.
+    std::vector<std::pair<std::string, std::string>> runs_;
+};
+
+/**
+ * @brief The process-wide trace.
+ */
+inline LockTrace &GlobalLockTrace()
+{
+    static LockTrace trace;
+    return trace;
+}
+
+/**
+ * @brief Consumes --lock_bench_trace=FILE from the command line and enables tracing.
+ * Returns false if FILE is empty.
+ */
+inline bool ParseTraceFlag(int *argc, char **argv)
+{
+    static const char kFlag[] = "--lock_bench_trace=";
+    bool ok = true;
+    int kept = 1;
+    for (int i = 1; i < *argc; ++i)
+    {
+        if (std::strncmp(argv[i], kFlag, sizeof(kFlag) - 1) != 0)
+        {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        const std::string path(argv[i] + sizeof(kFlag) - 1);
+        ok = ok && !path.empty();
+        GlobalLockTrace().Enable(path);
+    }
+    *argc = kept;
+    return ok;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file main.cpp
+ * @brief Entry point of lock_bench: registers every suite, records the host settings,
+ * then runs Google Benchmark.
+ */
+
+#include "bench_registry.h"
+#include "environment_check.h"
+#include "lock_trace.h"
+#include "suites.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdio>
+
+int main(int argc, char **argv)
+{
+    if (!ParseThreadSweepFlag(&argc, argv))
+    {
+        std::fprintf(stderr, "usage: --lock_bench_threads=N[,N...] with every N > 0\n");
+        return 1;
+    }
+    if (!ParseSchedulePeriodsFlag(&argc, argv))
+    {
+        std::fprintf(stderr, "usage: --lock_bench_schedule_periods=N with N >= 0\n");
+        return 1;
+    }
+    if (!ParseTraceFlag(&argc, argv))
+    {
+        std::fprintf(stderr, "usage: --lock_bench_trace=FILE\n");
+        return 1;
+    }
+    RegisterLockBenchmarks();
+    RegisterSkipListBenchmarks();
+    RegisterSoaBenchmarks();
+    RegisterPmrBenchmarks();
+    RegisterHandoffBenchmarks();
+    RegisterCrossProcessBenchmarks();
+
+    const bool listing = ListsTestsOnly(argc, argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    if (!listing)
+    {
+        RecordEnvironment();
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    if (GlobalLockTrace().Enabled() && !GlobalLockTrace().Write())
+    {
+        std::fprintf(stderr, "lock_bench: cannot write the lock trace\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file map_workloads.h
+ * @brief The std::map under test and the read and write workloads run against it.
+ * * DESIGN PRINCIPLE:
+ * Workloads take the map itself, never the lock: the lock policy decides how
+ * a workload is protected, and the same workload runs under every policy.
+ * Read workloads only get a const map, since operator[] may insert and would
+ * be a data race between concurrent readers.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <map>
+
+/// @brief Number of keys preloaded into the map.
+inline constexpr int kNumKeys = 1000;
+
+/// @brief The shared container of the lock comparison benchmarks.
+using MapData = std::map<int, double>;
+
+/**
+ * @brief Fills keys [0, kNumKeys) with sqrt(key).
+ */
+inline void FillMap(MapData &data)
+{
+    for (int i = 0; i < kNumKeys; ++i)
+    {
+        data[i] = std::sqrt(i);
+    }
+}
+
+/**
+ * @struct MapContext
+ * @brief The map and the @p Lock policy that guards it, rebuilt for each run.
+ * The policies keep their lock word on its own cache line (see lock_policies.h).
+ */
+template <typename Lock>
+struct MapContext
+{
+    MapData data;
+    Lock lock;
+
+    /**
+     * @brief Fills the data. Called once per run, before any thread starts.
+     */
+    void setup()
+    {
+        FillMap(data);
+    }
+};
+
+/**
+ * @brief Heavy Read Workload.
+ * Simulates real-world data processing (e.g., calculation or parsing).
+ */
+inline void DoHeavyRead(const MapData &data)
+{
+    double total = 0;
+    for (int i = 0; i < 50; ++i)
+    {
+        total += std::sin(data.find(i % kNumKeys)->second);
+    }
+    benchmark::DoNotOptimize(total);
+}
+
+/**
+ * @brief EXTREMELY LIGHT Read Workload.
+ * Perform a single lookup instead of 50 trig calculations.
+ */
+inline void DoLightRead(const MapData &data)
+{
+    double value = data.find(500)->second;
+    benchmark::DoNotOptimize(value);
+}
+
+/**
+ * @brief Range-Scan Read Workload.
+ * Iterates the contiguous keys [lo, lo + length) in order, as an analytics
+ * query would. The caller holds the lock for the whole walk, so long scans
+ * keep the writer out far longer than DoHeavyRead's 50 point lookups.
+ */
+inline void DoRangeScan(const MapData &data, int lo, int length)
+{
+    double total = 0;
+    const auto end = data.lower_bound(lo + length);
+    for (auto it = data.lower_bound(lo); it != end; ++it)
+    {
+        total += it->second;
+    }
+    benchmark::DoNotOptimize(total);
+}
+
+/**
+ * @brief Picks the next scan start so consecutive scans sweep the key space.
+ */
+inline int NextScanStart(int &cursor, int length)
+{
+    cursor = (cursor + 97) % (kNumKeys - length + 1);
+    return cursor;
+}
+
+/**
+ * @brief Write Workload.
+ * Simulates a state update (e.g., cache invalidation or value update).
+ */
+inline void DoWrite(MapData &data)
+{
+    data[0] += 1.1;
+    benchmark::DoNotOptimize(data[0]);
+}
+
+/**
+ * @brief Structural Write Workload.
+ * Erases one key and re-inserts it with an updated value, so every write frees
+ * and allocates a node and rebalances the tree twice. Both steps happen under
+ * the same exclusive lock, so readers never observe the key missing and the
+ * map size stays at kNumKeys.
+ */
+inline void DoInsertEraseWrite(MapData &data, int &cursor)
+{
+    const int key = cursor;
+    cursor = (cursor + 1) % kNumKeys;
+    auto it = data.find(key);
+    const double value = it->second + 1.1;
+    data.erase(it);
+    data.emplace(key, value);
+    benchmark::DoNotOptimize(data);
+}
+
+/**
+ * @brief Reload Write Workload.
+ * Rebuilds the whole map, as a configuration reload would. The caller holds
+ * the exclusive lock throughout, so readers see either the old or the new
+ * contents, and wait for the full rebuild.
+ */
+inline void DoReload(MapData &data, int epoch)
+{
+    data.clear();
+    for (int i = 0; i < kNumKeys; ++i)
+    {
+        data.emplace(i, std::sqrt(i) + epoch);
+    }
+    benchmark::DoNotOptimize(data);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file open_loop.h
+ * @brief Arrival schedules for open-loop load generation.
+ * * DESIGN PRINCIPLE:
+ * A closed-loop thread only issues its next operation after the previous one
+ * returns, so when the lock is slow it simply sends less load and the queueing
+ * delay never shows up (coordinated omission). An open-loop thread follows a
+ * fixed schedule of intended start times instead. Latency is measured from the
+ * intended start, not from when the thread got round to it, so time spent
+ * behind schedule is charged to the operation that caused it.
+ */
+
+#pragma once
+
+#include "spin_wait.h"
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+/**
+ * @enum Arrival
+ * @brief Inter-arrival distribution; used as a benchmark argument.
+ */
+enum Arrival
+{
+    kConstantRate = 0,
+    kPoisson = 1
+};
+
+/**
+ * @brief Name of @p arrival for benchmark labels.
+ */
+inline const char *ArrivalName(int arrival)
+{
+    return arrival == kPoisson ? "poisson" : "constant";
+}
+
+/**
+ * @class ArrivalSchedule
+ * @brief Produces the intended start time of each successive operation.
+ */
+class ArrivalSchedule
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param rate_per_sec Mean operations per second this schedule offers.
+     * @param arrival kConstantRate or kPoisson.
+     * @param seed Per-thread seed, so threads do not arrive in lockstep.
+     */
+    ArrivalSchedule(double rate_per_sec, int arrival, std::uint32_t seed)
+        : mean_interval_ns_(1e9 / rate_per_sec), arrival_(arrival), rng_(seed)
+    {
+    }
+
+    /**
+     * @brief Returns the intended start of the next operation and advances the schedule.
+     * The schedule never slips: if the caller is late, the next intended time is
+     * still one interval after this one, not after "now". The schedule starts
+     * at the first call, so time spent before the timed loop is not charged.
+     */
+    Clock::time_point Next()
+    {
+        if (!started_)
+        {
+            next_ = Clock::now();
+            started_ = true;
+        }
+        const Clock::time_point intended = next_;
+        double interval_ns = mean_interval_ns_;
+        if (arrival_ == kPoisson)
+        {
+            interval_ns = std::exponential_distribution<double>(1.0 / mean_interval_ns_)(rng_);
+        }
+        next_ += std::chrono::nanoseconds(static_cast<std::int64_t>(interval_ns));
+        return intended;
+    }
+
+  private:
+    double mean_interval_ns_;
+    int arrival_;
+    std::mt19937 rng_;
+    Clock::time_point next_;
+    bool started_ = false;
+};
+
+/**
+ * @brief Busy-waits until @p deadline. Sleeping is far too coarse for
+ * microsecond inter-arrival times, so this spins like the lock policies do
+ * (SpinWait), yielding once the wait outlasts a few microseconds.
+ */
+inline void SpinUntil(ArrivalSchedule::Clock::time_point deadline)
+{
+    SpinWait wait;
+    while (ArrivalSchedule::Clock::now() < deadline)
+    {
+        wait.Once();
+    }
+}
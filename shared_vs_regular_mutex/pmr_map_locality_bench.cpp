@@ -0,0 +1,213 @@
+/**
+ * @file pmr_map_locality_bench.cpp
+ * @brief Node locality of a locked std::map: global heap vs std::pmr arenas.
+ * * DESIGN PRINCIPLE:
+ * A std::map built in a long-running process gets its nodes from a heap that
+ * other code is also using, so consecutive keys end up on unrelated cache
+ * lines. Building the same map on a std::pmr::monotonic_buffer_resource or a
+ * std::pmr::unsynchronized_pool_resource packs the nodes together. Readers
+ * do pointer-chasing lookups with no math, so the critical section is bound by
+ * memory latency and the layout is what gets measured.
+ */
+
+#include "bench_registry.h"
+#include "lock_policies.h"
+#include "map_workloads.h"
+#include "suites.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @enum Layout
+ * @brief Where the map nodes come from; the alloc=... dimension.
+ */
+enum Layout
+{
+    kGlobalHeap = 0,
+    kMonotonic = 1,
+    kPool = 2
+};
+
+const char *LayoutName(int layout)
+{
+    switch (layout)
+    {
+    case kMonotonic:
+        return "pmr_monotonic";
+    case kPool:
+        return "pmr_pool";
+    default:
+        return "global_heap";
+    }
+}
+
+/**
+ * @struct LayoutContext
+ * @brief One map per layout, all holding the same keys and values, and the @p Lock guarding them.
+ */
+template <typename Lock>
+struct LayoutContext
+{
+    /// @brief Nodes from operator new, placed in the holes left between unrelated allocations.
+    std::map<int, double> heap_data;
+
+    /// @brief Unrelated allocations; the survivors keep heap_data's nodes apart.
+    std::vector<std::unique_ptr<char[]>> heap_noise;
+
+    /// @brief Bump allocator: nodes are laid out in insertion order.
+    std::pmr::monotonic_buffer_resource monotonic_resource{ kNumKeys * 64 };
+    std::pmr::map<int, double> monotonic_data{ &monotonic_resource };
+
+    /// @brief Size-class pool: nodes share chunks with other nodes only.
+    std::pmr::unsynchronized_pool_resource pool_resource;
+    std::pmr::map<int, double> pool_data{ &pool_resource };
+
+    Lock lock;
+
+    /**
+     * @brief Fills all three maps. Called once per run, before any thread starts.
+     */
+    void setup()
+    {
+        // Fixed seed so every run sees the same heap shape.
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> noise_size(16, 256);
+        for (int i = 0; i < 2 * kNumKeys; ++i)
+        {
+            heap_noise.emplace_back(new char[noise_size(rng)]);
+        }
+        // Free every other noise block, then build the map: its nodes land in
+        // the holes, scattered between the surviving blocks.
+        for (std::size_t i = 0; i < heap_noise.size(); i += 2)
+        {
+            heap_noise[i].reset();
+        }
+        for (int i = 0; i < kNumKeys; ++i)
+        {
+            heap_data[i] = std::sqrt(i);
+            monotonic_data[i] = std::sqrt(i);
+            pool_data[i] = std::sqrt(i);
+        }
+    }
+};
+
+/**
+ * @brief Average number of map nodes per distinct 64-byte line their key/value pairs occupy.
+ * 1 / (lines per node); values above 1 mean several nodes share a line.
+ */
+template <typename Map>
+double NodesPerCacheLine(const Map &map)
+{
+    std::unordered_set<std::uintptr_t> lines;
+    for (const auto &entry : map)
+    {
+        const auto begin = reinterpret_cast<std::uintptr_t>(&entry);
+        const auto end = begin + sizeof(entry) - 1;
+        for (std::uintptr_t line = begin / 64; line <= end / 64; ++line)
+        {
+            lines.insert(line);
+        }
+    }
+    return static_cast<double>(map.size()) / static_cast<double>(lines.size());
+}
+
+/**
+ * @brief Lookup Read Workload.
+ * 50 strided lookups, so each one walks a different root-to-leaf path.
+ */
+template <typename Map>
+void DoLookupRead(const Map &map)
+{
+    double total = 0;
+    for (int i = 0; i < 50; ++i)
+    {
+        total += map.find((i * 37) % kNumKeys)->second;
+    }
+    benchmark::DoNotOptimize(total);
+}
+
+/**
+ * @brief Write Workload.
+ * Updates a value in place, so no layout ever allocates during the run.
+ */
+template <typename Map>
+void DoLayoutWrite(Map &map)
+{
+    double &value = map[0];
+    value += 1.1;
+    benchmark::DoNotOptimize(value);
+}
+
+/**
+ * @brief Mixed loop shared by all layouts: one writer, N-1 readers.
+ */
+template <typename Lock, typename Map>
+void RunMixed(benchmark::State &state, Lock &lock, Map &map)
+{
+    std::int64_t reads = 0;
+    for (auto _ : state)
+    {
+        if (state.thread_index() == 0)
+        {
+            lock.write([&] { DoLayoutWrite(map); });
+        }
+        else
+        {
+            lock.read([&] { DoLookupRead(map); });
+            ++reads;
+        }
+    }
+    ReportReads(state, reads, state.threads() - 1);
+    state.counters["nodes_per_cache_line"] =
+        benchmark::Counter(NodesPerCacheLine(map), benchmark::Counter::kAvgThreads);
+}
+
+/**
+ * @brief Lookup workload over the map built with @p layout.
+ */
+template <typename Lock>
+void RegisterMapLayout(int layout)
+{
+    BenchName name;
+    name.Add("lock", Lock::kName).Add("container", "map").Add("alloc", LayoutName(layout));
+    name.Add("read", "lookup").Add("write", "update").Add("load", "closed");
+    RegisterWithContext<LayoutContext<Lock>>(name, [layout](benchmark::State &state, LayoutContext<Lock> &ctx) {
+        switch (layout)
+        {
+        case kMonotonic:
+            RunMixed(state, ctx.lock, ctx.monotonic_data);
+            break;
+        case kPool:
+            RunMixed(state, ctx.lock, ctx.pool_data);
+            break;
+        default:
+            RunMixed(state, ctx.lock, ctx.heap_data);
+            break;
+        }
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
+}
+
+} // namespace
+
+void RegisterPmrBenchmarks()
+{
+    AllLockPolicies::ForEach([](auto tag) {
+        for (int layout : { kGlobalHeap, kMonotonic, kPool })
+        {
+            RegisterMapLayout<typename decltype(tag)::type>(layout);
+        }
+    });
+}
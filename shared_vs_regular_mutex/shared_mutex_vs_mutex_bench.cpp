@@ -4,123 +4,1100 @@
  * * DESIGN PRINCIPLE:
  * This benchmark measures "Throughput Scaling." By increasing threads from 2 to 8,
  * we observe how the system handles increasing reader pressure against a
- * single constant writer.
+ * single constant writer. The same matrix is registered for every lock policy:
+ *
+ *   read   heavy (50 sin lookups), light (1 lookup), scan (scan_len keys)
+ *   write  update (data[0] += 1.1), insert_erase (node free + allocation)
+ *   load   single    one thread: the uncontended lock+unlock cost, empty or around the access
+ *          closed    every thread goes straight back into the lock
+ *          think     calibrated work outside the lock (duty = % of time locked)
+ *          open      operations on a fixed arrival schedule, latency from intended start
+ *          schedule  a background writer bursts or reloads every period_ms
+ *          background  a background writer queues updates lock-free (write=coalesce) that
+ *                      are applied write_batch at a time, or every flush_us, in one write
+ *   batch  closed loop where a reader does `batch` light reads per acquisition
+ *   fill   closed loop of cache fills: look a key up and, on a miss (miss_pct), write it,
+ *          by dropping to an exclusive re-lookup (reacquire) or in place (upgrade)
  */
 
-#include <benchmark/benchmark.h>
+#include "bench_registry.h"
+#include "bounded_queue.h"
+#include "latency_histogram.h"
+#include "lock_policies.h"
+#include "lock_profiler.h"
+#include "lock_trace.h"
+#include "map_workloads.h"
+#include "open_loop.h"
+#include "spin_wait.h"
+#include "suites.h"
+#include "think_time.h"
+
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <mutex>
-#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+namespace
+{
+
 /**
- * @struct BenchmarkContext
- * @brief Isolated data container to prevent "False Sharing."
- * * False Sharing occurs when two threads modify data on the same cache line.
- * alignas(64) ensures our mutexes are on separate cache lines, providing
- * the most accurate "pure" measurement of the locking mechanism itself.
+ * @enum ReadKind
+ * @brief The read workloads of map_workloads.h.
  */
-struct BenchmarkContext
+enum class ReadKind
+{
+    kHeavy,
+    kLight,
+    kScan
+};
+
+/**
+ * @struct ReadSpec
+ * @brief One value of the read=... dimension; scan_len is only used by kScan.
+ */
+struct ReadSpec
+{
+    ReadKind kind;
+    int scan_len;
+    const char *name;
+};
+
+const ReadSpec kHeavyRead{ ReadKind::kHeavy, 0, "heavy" };
+const ReadSpec kLightRead{ ReadKind::kLight, 0, "light" };
+
+ReadSpec ScanRead(int length)
 {
-    std::map<int, double> data;
+    return { ReadKind::kScan, length, "scan" };
+}
 
-    /// @brief Mutex for exclusive access (pessimistic).
-    alignas(64) std::mutex regular_mtx;
+/**
+ * @enum WriteKind
+ * @brief The writer's workload in the closed-loop, think and open benchmarks.
+ */
+enum class WriteKind
+{
+    kUpdate,
+    kInsertErase
+};
 
-    /// @brief Mutex for shared access (optimistic).
-    alignas(64) std::shared_mutex shared_mtx;
+const char *WriteName(WriteKind write)
+{
+    return write == WriteKind::kUpdate ? "update" : "insert_erase";
+}
+
+/**
+ * @brief Starts a benchmark name with the lock and container dimensions.
+ */
+template <typename Lock>
+BenchName MapBenchName()
+{
+    BenchName name;
+    name.Add("lock", Lock::kName).Add("container", "map");
+    return name;
+}
+
+void AddRead(BenchName &name, const ReadSpec &read)
+{
+    name.Add("read", read.name);
+    if (read.kind == ReadKind::kScan)
+    {
+        name.Add("scan_len", read.scan_len);
+    }
+}
+
+/**
+ * @brief Calls fn(read_op) with a callable that runs @p read on a const map.
+ * Each read kind is its own instantiation of fn, so the timed loop has no
+ * dispatch in it. Scans start from a per-thread cursor.
+ */
+template <typename Fn>
+void WithReadOp(const ReadSpec &read, int thread_index, Fn &&fn)
+{
+    switch (read.kind)
+    {
+    case ReadKind::kHeavy:
+        fn([](const MapData &data) { DoHeavyRead(data); });
+        break;
+    case ReadKind::kLight:
+        fn([](const MapData &data) { DoLightRead(data); });
+        break;
+    case ReadKind::kScan: {
+        int cursor = thread_index;
+        const int length = read.scan_len;
+        fn([&cursor, length](const MapData &data) { DoRangeScan(data, NextScanStart(cursor, length), length); });
+        break;
+    }
+    }
+}
+
+/**
+ * @brief Calls fn(write_op) with a callable that runs @p write on the map.
+ */
+template <typename Fn>
+void WithWriteOp(WriteKind write, Fn &&fn)
+{
+    if (write == WriteKind::kUpdate)
+    {
+        fn([](MapData &data) { DoWrite(data); });
+    }
+    else
+    {
+        int cursor = 0;
+        fn([&cursor](MapData &data) { DoInsertEraseWrite(data, cursor); });
+    }
+}
+
+/**
+ * @brief Uncontended cost of one @p read critical section, measured once per
+ * read workload on a private map, for the think-time benchmarks. The cache is
+ * keyed by kind and scan_len, so scans of different lengths are measured apart.
+ */
+double UncontendedReadNs(const ReadSpec &read)
+{
+    static std::mutex mtx;
+    static std::map<std::pair<ReadKind, int>, double> cached_ns;
+    std::lock_guard<std::mutex> lock(mtx);
+    double &ns = cached_ns[{ read.kind, read.scan_len }];
+    if (ns == 0)
+    {
+        MapData data;
+        FillMap(data);
+        WithReadOp(read, 0, [&](auto read_op) { ns = MeanNs([&] { read_op(data); }, 10000); });
+    }
+    return ns;
+}
+
+/**
+ * @struct UnlockedMapContext
+ * @brief The map alone, for the lock=none baselines of the single-threaded benchmarks.
+ */
+struct UnlockedMapContext
+{
+    MapData data;
 
-    /**
-     * @brief Setup shared data once.
-     */
     void setup()
     {
-        if (data.empty())
+        FillMap(data);
+    }
+};
+
+template <typename Op>
+void RunSingle(benchmark::State &state, Op &&op)
+{
+    for (auto _ : state)
+    {
+        op();
+    }
+}
+
+/**
+ * @brief Single-threaded lock+unlock: the uncontended fast path that most
+ * acquisitions take in production and the thread sweeps never show.
+ * @p exclusive picks write() (write=...) over read() (read=...); with
+ * @p access the section runs DoWrite or DoLightRead, otherwise it is empty
+ * (read=empty, write=empty) apart from a compiler barrier. Real time, since
+ * delegation spends the time on its server thread.
+ */
+template <typename Lock>
+void RegisterUncontended(bool exclusive, bool access)
+{
+    BenchName name = MapBenchName<Lock>();
+    name.Add(exclusive ? "write" : "read", access ? (exclusive ? "update" : "light") : "empty").Add("load", "single");
+    RegisterWithContext<MapContext<Lock>>(name, [exclusive, access](benchmark::State &state, MapContext<Lock> &ctx) {
+        if (exclusive && access)
+        {
+            RunSingle(state, [&] { ctx.lock.write([&] { DoWrite(ctx.data); }); });
+        }
+        else if (exclusive)
+        {
+            RunSingle(state, [&] { ctx.lock.write([] { benchmark::ClobberMemory(); }); });
+        }
+        else if (access)
+        {
+            RunSingle(state, [&] { ctx.lock.read([&] { DoLightRead(ctx.data); }); });
+        }
+        else
+        {
+            RunSingle(state, [&] { ctx.lock.read([] { benchmark::ClobberMemory(); }); });
+        }
+    })
+        ->UseRealTime();
+}
+
+/**
+ * @brief The data accesses of RegisterUncontended without a lock (lock=none);
+ * subtracting them leaves the cost of the lock itself.
+ */
+void RegisterUnlockedAccess()
+{
+    BenchName read_name;
+    read_name.Add("lock", "none").Add("container", "map").Add("read", "light").Add("load", "single");
+    RegisterWithContext<UnlockedMapContext>(read_name, [](benchmark::State &state, UnlockedMapContext &ctx) {
+        RunSingle(state, [&] { DoLightRead(ctx.data); });
+    })
+        ->UseRealTime();
+    BenchName write_name;
+    write_name.Add("lock", "none").Add("container", "map").Add("write", "update").Add("load", "single");
+    RegisterWithContext<UnlockedMapContext>(write_name, [](benchmark::State &state, UnlockedMapContext &ctx) {
+        RunSingle(state, [&] { DoWrite(ctx.data); });
+    })
+        ->UseRealTime();
+}
+
+/// @brief Upper bound on benchmark threads for the per-thread latency histograms.
+constexpr int kMaxThreads = kMaxTraceThreads;
+
+/// @brief Per-thread wait/hold profiles of the profile=wait_hold benchmarks.
+std::array<LockProfile, kMaxThreads> g_lock_profiles;
+
+/**
+ * @brief Closed loop: thread 0 writes, every other thread reads, back to back.
+ * With one writer and many readers, a policy that lets readers share scales;
+ * the "writes" counter is the writer's throughput, the starvation signal.
+ * With @p profile every acquisition goes through ProfiledLock, and thread 0
+ * reports the wait and hold percentiles (ns) of all threads after the run.
+ * Unprofiled runs are traced when --lock_bench_trace is given.
+ */
+template <typename Lock>
+void RegisterClosedLoop(const ReadSpec &read, WriteKind write, bool profile = false)
+{
+    BenchName name = MapBenchName<Lock>();
+    AddRead(name, read);
+    name.Add("write", WriteName(write)).Add("load", "closed");
+    if (profile)
+    {
+        name.Add("profile", "wait_hold");
+    }
+    RegisterWithContext<MapContext<Lock>>(name, [read, write, profile, name](benchmark::State &state,
+                                                                             MapContext<Lock> &ctx) {
+        auto run = [&](auto &lock) {
+            std::int64_t writes = 0;
+            std::int64_t reads = 0;
+            WithReadOp(read, state.thread_index(), [&](auto read_op) {
+                WithWriteOp(write, [&](auto write_op) {
+                    for (auto _ : state)
+                    {
+                        if (state.thread_index() == 0)
+                        {
+                            lock.write([&] { write_op(ctx.data); }); // 1 Writer
+                            ++writes;
+                        }
+                        else
+                        {
+                            lock.read([&] { read_op(ctx.data); }); // N-1 Readers
+                            ++reads;
+                        }
+                    }
+                });
+            });
+            state.counters["writes"] = benchmark::Counter(static_cast<double>(writes), benchmark::Counter::kIsRate);
+            ReportReads(state, reads, state.threads() - 1);
+        };
+        LockTrace &trace = GlobalLockTrace();
+        if (!profile && !trace.Enabled())
+        {
+            run(ctx.lock);
+            return;
+        }
+        if (state.threads() > kMaxThreads)
         {
-            for (int i = 0; i < 1000; ++i)
+            state.SkipWithError("too many threads to profile or trace");
+            return;
+        }
+        if (!profile)
+        {
+            trace.Ring(state.thread_index()).Reset();
+            TracedLock<Lock> traced(ctx.lock, trace.Ring(state.thread_index()));
+            run(traced);
+            if (state.thread_index() == 0)
             {
-                data[i] = std::sqrt(i);
+                trace.Collect(name.str() + "/real_time/threads:" + std::to_string(state.threads()), state.threads());
             }
+            return;
         }
+        // Each thread clears only its own profile; the timed loop ends on a barrier.
+        g_lock_profiles[state.thread_index()].Reset();
+        ProfiledLock<Lock> profiled(ctx.lock, g_lock_profiles[state.thread_index()]);
+        run(profiled);
+        if (state.thread_index() == 0)
+        {
+            LockProfile merged;
+            for (int t = 0; t < state.threads(); ++t)
+            {
+                merged.Merge(g_lock_profiles[t]);
+            }
+            ReportLockProfile(state, merged);
+        }
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
+}
+
+/**
+ * @brief Closed loop with batched reads: each reader acquisition runs
+ * DoLightRead @p batch times. items_per_second counts individual reads, so
+ * comparing it across batch sizes shows when the per-acquisition cost of the
+ * lock stops mattering next to the reads it protects.
+ */
+template <typename Lock>
+void RegisterBatchedReads(int batch)
+{
+    BenchName name = MapBenchName<Lock>();
+    name.Add("read", kLightRead.name).Add("batch", batch).Add("write", "update").Add("load", "closed");
+    RegisterWithContext<MapContext<Lock>>(name, [batch](benchmark::State &state, MapContext<Lock> &ctx) {
+        std::int64_t reads = 0;
+        for (auto _ : state)
+        {
+            if (state.thread_index() == 0)
+            {
+                ctx.lock.write([&] { DoWrite(ctx.data); });
+            }
+            else
+            {
+                ctx.lock.read([&] {
+                    for (int i = 0; i < batch; ++i)
+                    {
+                        DoLightRead(ctx.data);
+                    }
+                });
+                reads += batch;
+            }
+        }
+        state.SetItemsProcessed(reads);
+        ReportReads(state, reads, state.threads() - 1);
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
+}
+
+/**
+ * @struct PairedMapContext
+ * @brief Two independent maps, each behind its own @p Lock.
+ */
+template <typename Lock>
+struct PairedMapContext
+{
+    MapContext<Lock> maps[2];
+
+    void setup()
+    {
+        maps[0].setup();
+        maps[1].setup();
     }
 };
 
-/// @brief Global context instance for the benchmark.
-static BenchmarkContext g_ctx;
+/**
+ * @brief Closed loop over two lock instances: every thread alternates
+ * between the two maps, one acquisition each. Policies that keep per-thread
+ * state per lock (the publication slots of flat combining and delegation)
+ * must keep it for both instances at once, not re-register on every switch.
+ */
+template <typename Lock>
+void RegisterTwoInstances()
+{
+    BenchName name = MapBenchName<Lock>();
+    name.Add("read", kLightRead.name).Add("write", "update").Add("load", "closed").Add("instances", 2);
+    RegisterWithContext<PairedMapContext<Lock>>(name, [](benchmark::State &state, PairedMapContext<Lock> &ctx) {
+        std::int64_t writes = 0;
+        std::int64_t reads = 0;
+        int next = 0;
+        for (auto _ : state)
+        {
+            MapContext<Lock> &map = ctx.maps[next];
+            next ^= 1;
+            if (state.thread_index() == 0)
+            {
+                map.lock.write([&] { DoWrite(map.data); });
+                ++writes;
+            }
+            else
+            {
+                map.lock.read([&] { DoLightRead(map.data); });
+                ++reads;
+            }
+        }
+        state.counters["writes"] = benchmark::Counter(static_cast<double>(writes), benchmark::Counter::kIsRate);
+        ReportReads(state, reads, state.threads() - 1);
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
+}
+
+/// @brief Key stride of the cache-fill cursors; coprime with kNumKeys, so misses are spread out.
+constexpr int kFillStride = 919;
 
 /**
- * @brief Heavy Read Workload.
- * Simulates real-world data processing (e.g., calculation or parsing).
+ * @brief The value below which a cached entry counts as stale. FillMap stores
+ * sqrt(key), so that is @p miss_pct percent of the keys.
  */
-void DoHeavyRead()
+double StaleBelow(int miss_pct)
 {
-    double total = 0;
-    for (int i = 0; i < 50; ++i)
+    return std::sqrt(kNumKeys * miss_pct / 100.0);
+}
+
+/**
+ * @brief One cache fill: reads @p key and, if the value is stale, refreshes
+ * it. With @p upgrade the check runs under upgrade ownership and the write
+ * reuses the iterator; otherwise the shared lock is dropped and the key is
+ * looked up and checked again under the exclusive lock. Returns true if it wrote.
+ */
+template <typename Lock>
+bool FillIfStale(MapContext<Lock> &ctx, int key, double stale_below, bool upgrade)
+{
+    bool filled = false;
+    if constexpr (SupportsUpgrade<Lock>::value)
     {
-        total += std::sin(g_ctx.data[i % 1000]);
+        if (upgrade)
+        {
+            MapData::iterator it;
+            ctx.lock.upgrade(
+                [&] {
+                    it = ctx.data.find(key);
+                    return it->second < stale_below;
+                },
+                [&] {
+                    it->second = std::sqrt(key);
+                    filled = true;
+                });
+            return filled;
+        }
+    }
+    bool stale = false;
+    ctx.lock.read([&] { stale = ctx.data.find(key)->second < stale_below; });
+    if (stale)
+    {
+        ctx.lock.write([&] {
+            auto it = ctx.data.find(key);
+            if (it->second < stale_below)
+            {
+                it->second = std::sqrt(key);
+                filled = true;
+            }
+        });
     }
-    benchmark::DoNotOptimize(total);
+    return filled;
 }
 
 /**
- * @brief Write Workload.
- * Simulates a state update (e.g., cache invalidation or value update).
+ * @brief Closed loop of cache fills on every thread; there is no dedicated
+ * writer, each thread writes the stale entries it reads. A fill stores the
+ * same sqrt(key) again, so the entry stays stale and the miss rate stays at
+ * miss_pct. "fills" counts the writes.
  */
-void DoWrite()
+template <typename Lock>
+void RegisterCacheFill(bool upgrade, int miss_pct)
 {
-    g_ctx.data[0] += 1.1;
-    benchmark::DoNotOptimize(g_ctx.data[0]);
+    BenchName name = MapBenchName<Lock>();
+    name.Add("read", "fill").Add("write", upgrade ? "upgrade" : "reacquire").Add("load", "closed");
+    name.Add("miss_pct", miss_pct);
+    RegisterWithContext<MapContext<Lock>>(name, [upgrade, miss_pct](benchmark::State &state, MapContext<Lock> &ctx) {
+        const double stale_below = StaleBelow(miss_pct);
+        int key = state.thread_index() * kNumKeys / state.threads();
+        std::int64_t fills = 0;
+        for (auto _ : state)
+        {
+            fills += FillIfStale(ctx, key, stale_below, upgrade) ? 1 : 0;
+            key = (key + kFillStride) % kNumKeys;
+        }
+        state.counters["fills"] = benchmark::Counter(static_cast<double>(fills), benchmark::Counter::kIsRate);
+        ReportReads(state, state.iterations(), state.threads());
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
 }
 
 /**
- * @brief Benchmark: Regular Mutex (Mixed Workload).
- * All threads are serialized. Adding threads increases wait time linearly.
+ * @brief Closed loop with think time: @p duty is each thread's lock duty cycle
+ * in percent (100 is the plain closed loop). Every thread, writer included,
+ * spins for the same number of ns after each critical section.
  */
-static void BM_RegularMutex_Mixed(benchmark::State &state)
+template <typename Lock>
+void RegisterThinkTime(const ReadSpec &read, int duty)
 {
-    g_ctx.setup();
-    for (auto _ : state)
+    BenchName name = MapBenchName<Lock>();
+    AddRead(name, read);
+    name.Add("write", "update").Add("load", "think").Add("duty", duty);
+    RegisterWithContext<MapContext<Lock>>(name, [read, duty](benchmark::State &state, MapContext<Lock> &ctx) {
+        const std::uint64_t think_ns = ThinkNsForDutyCycle(UncontendedReadNs(read), duty);
+        state.counters["think_ns"] = benchmark::Counter(static_cast<double>(think_ns), benchmark::Counter::kAvgThreads);
+        std::int64_t reads = 0;
+        WithReadOp(read, state.thread_index(), [&](auto read_op) {
+            for (auto _ : state)
+            {
+                if (state.thread_index() == 0)
+                {
+                    ctx.lock.write([&] { DoWrite(ctx.data); });
+                }
+                else
+                {
+                    ctx.lock.read([&] { read_op(ctx.data); });
+                    ++reads;
+                }
+                ThinkFor(think_ns);
+            }
+        });
+        ReportReads(state, reads, state.threads() - 1);
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
+}
+
+/// @brief Per-thread latency histograms for the open-loop benchmarks; slot 0 is the writer.
+std::array<LatencyHistogram, kMaxThreads> g_open_loop_latency;
+
+/**
+ * @brief Nanoseconds from the intended start of an operation until now.
+ */
+std::uint64_t SinceIntended(ArrivalSchedule::Clock::time_point intended)
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(ArrivalSchedule::Clock::now() - intended).count());
+}
+
+/**
+ * @brief Thread 0's epilogue of an open-loop run. The timed loop ends on a
+ * barrier, so by now every thread has stopped recording.
+ */
+void ReportOpenLoop(benchmark::State &state)
+{
+    LatencyHistogram readers;
+    for (int t = 1; t < state.threads(); ++t)
     {
-        std::lock_guard<std::mutex> lock(g_ctx.regular_mtx);
+        readers.Merge(g_open_loop_latency[t]);
+    }
+    ReportLatency(state, readers, "read");
+    state.counters["write_p99"] = static_cast<double>(g_open_loop_latency[0].Percentile(99.0));
+}
+
+/**
+ * @brief Open loop: every thread offers @p rate operations per second on its
+ * own schedule. Latency counters (ns) include time spent behind schedule.
+ */
+template <typename Lock>
+void RegisterOpenLoop(const ReadSpec &read, int rate, int arrival)
+{
+    BenchName name = MapBenchName<Lock>();
+    AddRead(name, read);
+    name.Add("write", "update").Add("load", "open").Add("rate", rate).Add("arrival", ArrivalName(arrival));
+    RegisterWithContext<MapContext<Lock>>(name, [read, rate, arrival](benchmark::State &state,
+                                                                      MapContext<Lock> &ctx) {
+        if (state.threads() > kMaxThreads)
+        {
+            state.SkipWithError("too many threads for the latency histograms");
+            return;
+        }
+        // Each thread clears only its own histogram, so no synchronization is needed.
+        LatencyHistogram &latency = g_open_loop_latency[state.thread_index()];
+        latency.Reset();
+        ArrivalSchedule schedule(rate, arrival, 1234u + static_cast<unsigned>(state.thread_index()));
+        WithReadOp(read, state.thread_index(), [&](auto read_op) {
+            for (auto _ : state)
+            {
+                const auto intended = schedule.Next();
+                SpinUntil(intended);
+                if (state.thread_index() == 0)
+                {
+                    ctx.lock.write([&] { DoWrite(ctx.data); });
+                }
+                else
+                {
+                    ctx.lock.read([&] { read_op(ctx.data); });
+                }
+                latency.Record(SinceIntended(intended));
+            }
+        });
+        state.SetItemsProcessed(state.iterations());
         if (state.thread_index() == 0)
         {
-            DoWrite(); // 1 Writer
+            ReportOpenLoop(state);
+        }
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
+}
+
+/**
+ * @enum WriterMode
+ * @brief Background writer schedules for the load=schedule benchmarks.
+ */
+enum WriterMode
+{
+    /// @brief kBurstSize separate exclusive writes, once per period.
+    kPeriodicBurst = 0,
+    /// @brief One DoReload under a single exclusive lock, once per period.
+    kReload = 1
+};
+
+/// @brief Writes per burst in kPeriodicBurst mode.
+constexpr int kBurstSize = 1000;
+
+/**
+ * @struct ScheduleContext
+ * @brief MapContext plus the state the background writer shares with the readers.
+ */
+template <typename Lock>
+struct ScheduleContext : MapContext<Lock>
+{
+    /// @brief Set by the background writer while a burst or reload is in progress.
+    std::atomic<bool> write_in_progress{ false };
+    /// @brief Set by the first read of the run; the writer holds its first event until then.
+    std::atomic<bool> reading{ false };
+    /// @brief Bursts or reloads completed; written by the writer, read after it is joined.
+    std::int64_t events = 0;
+};
+
+/// @brief Per-thread read latency, split by whether a write burst overlapped the read.
+std::array<LatencyHistogram, kMaxThreads> g_read_latency_burst;
+std::array<LatencyHistogram, kMaxThreads> g_read_latency_idle;
+
+/**
+ * @brief Background writer loop: runs one burst or reload as soon as the
+ * readers are in the timed loop and then once per period, with
+ * write_in_progress raised, until @p stop is set.
+ */
+template <typename Lock>
+void RunWriterSchedule(ScheduleContext<Lock> &ctx, int mode, int period_ms, const std::atomic<bool> &stop)
+{
+    while (!ctx.reading.load(std::memory_order_acquire) && !stop.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    auto next = std::chrono::steady_clock::now();
+    int epoch = 0;
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        if (std::chrono::steady_clock::now() < next)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        ctx.write_in_progress.store(true, std::memory_order_release);
+        if (mode == kReload)
+        {
+            ++epoch;
+            ctx.lock.write([&] { DoReload(ctx.data, epoch); });
         }
         else
         {
-            DoHeavyRead(); // N-1 Readers
+            for (int i = 0; i < kBurstSize; ++i)
+            {
+                ctx.lock.write([&] { DoWrite(ctx.data); });
+            }
         }
+        ctx.write_in_progress.store(false, std::memory_order_release);
+        ++ctx.events;
+        next += std::chrono::milliseconds(period_ms);
     }
 }
-// Incrementally test 2, 4, and 8 threads to show the scaling curve.
-BENCHMARK(BM_RegularMutex_Mixed)->ThreadRange(2, 8)->UseRealTime();
 
 /**
- * @brief Benchmark: Shared Mutex (Mixed Workload).
- * Readers run in parallel while the Writer is idle.
- * Throughput should increase with thread count.
+ * @brief Records one read latency in the burst or idle histogram of this thread.
+ * A read counts as "burst" if a write was in progress when it started or ended.
  */
-static void BM_SharedMutex_Mixed(benchmark::State &state)
+template <typename Lock>
+void RecordScheduledRead(benchmark::State &state, ScheduleContext<Lock> &ctx,
+                         std::chrono::steady_clock::time_point start, bool burst_at_start)
 {
-    g_ctx.setup();
-    for (auto _ : state)
+    const bool burst = burst_at_start || ctx.write_in_progress.load(std::memory_order_acquire);
+    const auto ns = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    (burst ? g_read_latency_burst : g_read_latency_idle)[state.thread_index()].Record(ns);
+}
+
+/**
+ * @brief Thread 0's epilogue: merges every reader's histograms and reports
+ * them. A run that lasted @p full_period or longer without any read
+ * overlapping a burst has no burst percentiles to report and fails; shorter
+ * runs only size the iteration count and are discarded by the library.
+ */
+void ReportScheduledReads(benchmark::State &state, std::int64_t events, bool full_period)
+{
+    LatencyHistogram burst;
+    LatencyHistogram idle;
+    for (int t = 0; t < state.threads(); ++t)
     {
+        burst.Merge(g_read_latency_burst[t]);
+        idle.Merge(g_read_latency_idle[t]);
+    }
+    if (burst.Count() == 0)
+    {
+        if (full_period)
+        {
+            state.SkipWithError("no read overlapped a write burst");
+        }
+        return;
+    }
+    ReportLatency(state, burst, "burst");
+    ReportLatency(state, idle, "idle");
+    state.counters["burst_reads"] = static_cast<double>(burst.Count());
+    state.counters["bursts"] = static_cast<double>(events);
+}
+
+/**
+ * @brief Scheduled background writer: every benchmark thread is a reader;
+ * thread 0 also owns a writer thread that follows the schedule for the whole
+ * timed region. Latency counters (ns) compare reads that overlapped a write
+ * burst with reads that did not. The first event fires with the first read,
+ * and each run lasts at least SchedulePeriodsPerRun() periods.
+ */
+template <typename Lock>
+void RegisterWriterSchedule(int mode, int period_ms)
+{
+    BenchName name = MapBenchName<Lock>();
+    AddRead(name, kHeavyRead);
+    name.Add("write", mode == kReload ? "reload" : "burst").Add("load", "schedule").Add("period_ms", period_ms);
+    auto *bench = RegisterWithContext<ScheduleContext<Lock>>(name, [mode, period_ms](benchmark::State &state,
+                                                                                     ScheduleContext<Lock> &ctx) {
+        if (state.threads() > kMaxThreads)
+        {
+            state.SkipWithError("too many threads for the latency histograms");
+            return;
+        }
+        g_read_latency_burst[state.thread_index()].Reset();
+        g_read_latency_idle[state.thread_index()].Reset();
+        std::atomic<bool> stop{ false };
+        std::thread writer;
         if (state.thread_index() == 0)
         {
-            // Exclusive lock for the writer
-            std::unique_lock<std::shared_mutex> lock(g_ctx.shared_mtx);
-            DoWrite();
+            writer = std::thread(RunWriterSchedule<Lock>, std::ref(ctx), mode, period_ms, std::cref(stop));
+        }
+        const auto run_start = std::chrono::steady_clock::now();
+        for (auto _ : state)
+        {
+            const bool burst_at_start = ctx.write_in_progress.load(std::memory_order_acquire);
+            const auto start = std::chrono::steady_clock::now();
+            ctx.lock.read([&] { DoHeavyRead(ctx.data); });
+            if (!ctx.reading.load(std::memory_order_relaxed))
+            {
+                ctx.reading.store(true, std::memory_order_release);
+            }
+            RecordScheduledRead(state, ctx, start, burst_at_start);
+        }
+        ReportReads(state, state.iterations(), state.threads());
+        if (state.thread_index() == 0)
+        {
+            stop.store(true);
+            writer.join();
+            ReportScheduledReads(state, ctx.events,
+                                 std::chrono::steady_clock::now() - run_start >= std::chrono::milliseconds(period_ms));
+        }
+    });
+    bench->Apply(SweepThreads)->UseRealTime();
+    if (SchedulePeriodsPerRun() > 0)
+    {
+        bench->MinTime(SchedulePeriodsPerRun() * period_ms / 1000.0);
+    }
+}
+
+/**
+ * @struct MapUpdate
+ * @brief One queued write of the coalescing writer, stamped when it was queued.
+ */
+struct MapUpdate
+{
+    int key;
+    double delta;
+    std::chrono::steady_clock::time_point queued;
+};
+
+/// @brief Queued updates before the writer has to wait for a flush.
+constexpr std::size_t kUpdateQueueCapacity = 1 << 16;
+
+/**
+ * @struct CoalescingContext
+ * @brief MapContext plus the queue of updates not yet applied to the map.
+ */
+template <typename Lock>
+struct CoalescingContext : MapContext<Lock>
+{
+    BoundedQueue<MapUpdate> queue{ kUpdateQueueCapacity };
+};
+
+/**
+ * @struct CoalescingStats
+ * @brief Writer-side results; `queued` belongs to the writer thread, the rest
+ * to whichever thread flushes. Read only after both have been joined.
+ */
+struct CoalescingStats
+{
+    std::int64_t queued = 0;
+    std::int64_t flushes = 0;
+    std::int64_t applied = 0;
+    LatencyHistogram staleness;
+    std::vector<MapUpdate> batch;
+    /// @brief Periodic flusher wake-ups and the first and last of them.
+    std::int64_t wakeups = 0;
+    std::chrono::steady_clock::time_point first_wakeup;
+    std::chrono::steady_clock::time_point last_wakeup;
+};
+
+/// @brief Flush intervals below this are waited out spinning; sleep_until's timer slack is tens of us.
+constexpr int kMinSleepingFlushUs = 100;
+
+/**
+ * @brief Drains the queue and applies everything in it under one exclusive
+ * acquisition. Staleness is how long each update was invisible to readers:
+ * from being queued until the exclusive section that applied it ended.
+ * Single consumer only. Returns false if the queue was empty.
+ */
+template <typename Lock>
+bool FlushUpdates(CoalescingContext<Lock> &ctx, CoalescingStats &stats)
+{
+    stats.batch.clear();
+    MapUpdate update;
+    while (stats.batch.size() < kUpdateQueueCapacity && ctx.queue.TryPop(update))
+    {
+        stats.batch.push_back(update);
+    }
+    if (stats.batch.empty())
+    {
+        return false;
+    }
+    ctx.lock.write([&] {
+        for (const MapUpdate &queued : stats.batch)
+        {
+            ctx.data.find(queued.key)->second += queued.delta;
+        }
+    });
+    const auto applied = std::chrono::steady_clock::now();
+    for (const MapUpdate &queued : stats.batch)
+    {
+        stats.staleness.Record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(applied - queued.queued).count()));
+    }
+    ++stats.flushes;
+    stats.applied += static_cast<std::int64_t>(stats.batch.size());
+    return true;
+}
+
+/**
+ * @brief Background writer: queues updates back to back until @p stop is set,
+ * flushing after every @p write_batch of them if that is non-zero. A full
+ * queue makes it wait for the flusher.
+ */
+template <typename Lock>
+void RunCoalescingWriter(CoalescingContext<Lock> &ctx, int write_batch, const std::atomic<bool> &stop,
+                         CoalescingStats &stats)
+{
+    int key = 0;
+    int since_flush = 0;
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        const MapUpdate update{ key, 1.1, std::chrono::steady_clock::now() };
+        key = key + 1 == kNumKeys ? 0 : key + 1;
+        SpinWait wait;
+        while (!ctx.queue.TryPush(update))
+        {
+            if (stop.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            wait.Once();
+        }
+        ++stats.queued;
+        if (write_batch > 0 && ++since_flush == write_batch)
+        {
+            FlushUpdates(ctx, stats);
+            since_flush = 0;
+        }
+    }
+}
+
+/**
+ * @brief Background flusher: applies whatever is queued every @p flush_us until
+ * @p stop is set. Intervals under kMinSleepingFlushUs are spun, not slept,
+ * and every wake-up is counted so the interval actually achieved is reported.
+ */
+template <typename Lock>
+void RunPeriodicFlusher(CoalescingContext<Lock> &ctx, int flush_us, const std::atomic<bool> &stop,
+                        CoalescingStats &stats)
+{
+    auto next = std::chrono::steady_clock::now();
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        next += std::chrono::microseconds(flush_us);
+        if (flush_us < kMinSleepingFlushUs)
+        {
+            SpinWait wait;
+            while (std::chrono::steady_clock::now() < next && !stop.load(std::memory_order_relaxed))
+            {
+                wait.Once();
+            }
         }
         else
         {
-            // Shared lock for all readers
-            std::shared_lock<std::shared_mutex> lock(g_ctx.shared_mtx);
-            DoHeavyRead();
+            std::this_thread::sleep_until(next);
+        }
+        stats.last_wakeup = std::chrono::steady_clock::now();
+        if (stats.wakeups++ == 0)
+        {
+            stats.first_wakeup = stats.last_wakeup;
+        }
+        FlushUpdates(ctx, stats);
+    }
+}
+
+/**
+ * @brief Coalescing writer: every benchmark thread runs heavy reads while
+ * thread 0 owns a background writer that queues updates lock-free, flat out.
+ * With @p write_batch set the writer applies them itself after that many;
+ * with @p flush_us set a second background thread applies them on that
+ * interval. "writes" is the rate updates were queued, "mean_batch" the
+ * updates per exclusive acquisition, "stale_*" (ns) the delay before
+ * readers could see an update (updates still queued at the end are applied
+ * and counted), and "flush_interval_us" the flusher's measured interval.
+ */
+template <typename Lock>
+void RegisterCoalescedWrites(int write_batch, int flush_us)
+{
+    BenchName name = MapBenchName<Lock>();
+    AddRead(name, kHeavyRead);
+    name.Add("write", "coalesce").Add("load", "background");
+    if (write_batch > 0)
+    {
+        name.Add("write_batch", write_batch);
+    }
+    else
+    {
+        name.Add("flush_us", flush_us);
+    }
+    RegisterWithContext<CoalescingContext<Lock>>(name, [write_batch, flush_us](benchmark::State &state,
+                                                                               CoalescingContext<Lock> &ctx) {
+        CoalescingStats stats;
+        std::atomic<bool> stop{ false };
+        std::thread writer;
+        std::thread flusher;
+        if (state.thread_index() == 0)
+        {
+            stats.batch.reserve(kUpdateQueueCapacity);
+            writer = std::thread(RunCoalescingWriter<Lock>, std::ref(ctx), write_batch, std::cref(stop),
+                                 std::ref(stats));
+            if (flush_us > 0)
+            {
+                flusher = std::thread(RunPeriodicFlusher<Lock>, std::ref(ctx), flush_us, std::cref(stop),
+                                      std::ref(stats));
+            }
+        }
+        for (auto _ : state)
+        {
+            ctx.lock.read([&] { DoHeavyRead(ctx.data); });
+        }
+        ReportReads(state, state.iterations(), state.threads());
+        if (state.thread_index() == 0)
+        {
+            stop.store(true, std::memory_order_relaxed);
+            writer.join();
+            if (flusher.joinable())
+            {
+                flusher.join();
+            }
+            while (FlushUpdates(ctx, stats))
+            {
+            }
+            if (stats.wakeups > 1)
+            {
+                const auto span = std::chrono::duration_cast<std::chrono::nanoseconds>(stats.last_wakeup -
+                                                                                       stats.first_wakeup);
+                state.counters["flush_interval_us"] =
+                    static_cast<double>(span.count()) / 1000.0 / static_cast<double>(stats.wakeups - 1);
+            }
+            state.counters["writes"] = benchmark::Counter(static_cast<double>(stats.queued),
+                                                          benchmark::Counter::kIsRate);
+            state.counters["mean_batch"] = stats.flushes > 0 ? static_cast<double>(stats.applied) /
+                                                                   static_cast<double>(stats.flushes)
+                                                             : 0.0;
+            ReportLatency(state, stats.staleness, "stale");
+        }
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
+}
+
+/**
+ * @brief The full matrix for one lock policy.
+ */
+template <typename Lock>
+void RegisterLockMatrix()
+{
+    // Uncontended: shared and exclusive, each empty and around the data access.
+    for (bool exclusive : { false, true })
+    {
+        for (bool access : { false, true })
+        {
+            RegisterUncontended<Lock>(exclusive, access);
+        }
+    }
+    for (const ReadSpec &read : { kHeavyRead, kLightRead, ScanRead(10), ScanRead(100), ScanRead(1000) })
+    {
+        for (WriteKind write : { WriteKind::kUpdate, WriteKind::kInsertErase })
+        {
+            RegisterClosedLoop<Lock>(read, write);
+        }
+    }
+    // The same closed loops with wait and hold time profiled, to explain their throughput.
+    for (const ReadSpec &read : { kHeavyRead, kLightRead })
+    {
+        RegisterClosedLoop<Lock>(read, WriteKind::kUpdate, true);
+    }
+    // Light reads per shared acquisition; batch 1 is read=light/load=closed.
+    for (int batch : { 1, 4, 16, 64, 256 })
+    {
+        RegisterBatchedReads<Lock>(batch);
+    }
+    // The light closed loop, alternating between two lock instances.
+    RegisterTwoInstances<Lock>();
+    // Cache fills at 1%, 10% and 50% misses, in place only where the policy can upgrade.
+    for (int miss_pct : { 1, 10, 50 })
+    {
+        RegisterCacheFill<Lock>(false, miss_pct);
+        if constexpr (SupportsUpgrade<Lock>::value)
+        {
+            RegisterCacheFill<Lock>(true, miss_pct);
         }
     }
+    // Lock duty cycles of 5%, 20% and 80%; 100% is load=closed.
+    for (const ReadSpec &read : { kHeavyRead, kLightRead })
+    {
+        for (int duty : { 5, 20, 80 })
+        {
+            RegisterThinkTime<Lock>(read, duty);
+        }
+    }
+    // Per-thread offered rate (ops/s) x arrival process.
+    for (int rate : { 10000, 50000, 100000, 200000 })
+    {
+        for (int arrival : { kConstantRate, kPoisson })
+        {
+            RegisterOpenLoop<Lock>(kHeavyRead, rate, arrival);
+        }
+    }
+    // Coalesced writes, flushed by count and by time; write_batch 1 is one write per update.
+    for (int write_batch : { 1, 16, 256 })
+    {
+        RegisterCoalescedWrites<Lock>(write_batch, 0);
+    }
+    for (int flush_us : { 10, 100, 1000 })
+    {
+        RegisterCoalescedWrites<Lock>(0, flush_us);
+    }
+    // 1000-write bursts every 100 ms; reloads every 100 ms and every 500 ms.
+    RegisterWriterSchedule<Lock>(kPeriodicBurst, 100);
+    RegisterWriterSchedule<Lock>(kReload, 100);
+    RegisterWriterSchedule<Lock>(kReload, 500);
 }
-// Incrementally test 2, 4, and 8 threads to show the scaling curve.
-BENCHMARK(BM_SharedMutex_Mixed)->ThreadRange(2, 8)->UseRealTime();
 
-BENCHMARK_MAIN();
\ No newline at end of file
+} // namespace
+
+void RegisterLockBenchmarks()
+{
+    RegisterUnlockedAccess();
+    AllLockPolicies::ForEach([](auto tag) { RegisterLockMatrix<typename decltype(tag)::type>(); });
+}
@@ -0,0 +1,276 @@
+/**
+ * @file shared_table.h
+ * @brief A lookup table in POSIX shared memory with the process-shared locks that guard it.
+ * * DESIGN PRINCIPLE:
+ * Worker processes that share a table through mmap cannot use std::map or
+ * std::shared_mutex: the map's nodes are private heap pointers, and the
+ * standard locks make no promise about working across address spaces. The
+ * table is therefore a flat array of kNumKeys values, and the two locks are
+ * built only from what is valid in shared memory: a pthread_rwlock_t with
+ * PTHREAD_PROCESS_SHARED, and a seqlock made of lock-free atomics. Both keep
+ * the read(fn)/write(fn) interface of lock_policies.h; kProcessShared says
+ * whether a policy may be used from forked processes. Values are atomics,
+ * loaded with acquire and stored with release, so a seqlock reader may race
+ * with the writer without undefined behaviour and without fences; on x86
+ * both are plain movs.
+ */
+
+#pragma once
+
+#include "map_workloads.h"
+#include "spin_wait.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <string>
+
+/**
+ * @class PthreadRwMutex
+ * @brief pthread_rwlock_t with the SharedMutex member functions, so std::shared_lock and std::unique_lock apply.
+ * With @p process_shared it is initialized PTHREAD_PROCESS_SHARED and works
+ * from any process mapping it. Either way writers are preferred: glibc's
+ * default kind lets new readers overtake a waiting writer, so readers that
+ * never pause would starve it for good.
+ */
+class PthreadRwMutex
+{
+  public:
+    explicit PthreadRwMutex(bool process_shared)
+    {
+        pthread_rwlockattr_t attr;
+        pthread_rwlockattr_init(&attr);
+        pthread_rwlockattr_setpshared(&attr, process_shared ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE);
+        pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+        pthread_rwlock_init(&rwlock_, &attr);
+        pthread_rwlockattr_destroy(&attr);
+    }
+
+    ~PthreadRwMutex()
+    {
+        pthread_rwlock_destroy(&rwlock_);
+    }
+
+    PthreadRwMutex(const PthreadRwMutex &) = delete;
+    PthreadRwMutex &operator=(const PthreadRwMutex &) = delete;
+
+    void lock()
+    {
+        pthread_rwlock_wrlock(&rwlock_);
+    }
+
+    void unlock()
+    {
+        pthread_rwlock_unlock(&rwlock_);
+    }
+
+    void lock_shared()
+    {
+        pthread_rwlock_rdlock(&rwlock_);
+    }
+
+    void unlock_shared()
+    {
+        pthread_rwlock_unlock(&rwlock_);
+    }
+
+  private:
+    pthread_rwlock_t rwlock_;
+};
+
+/**
+ * @class BasicPthreadRwLock
+ * @brief Lock policy over a PthreadRwMutex. "pthread_rwlock" is process-shared;
+ * "pthread_rwlock_private" is the same lock kind within one process, the
+ * baseline that isolates what process sharing costs.
+ */
+template <bool ProcessShared>
+class BasicPthreadRwLock
+{
+  public:
+    static constexpr const char *kName = ProcessShared ? "pthread_rwlock" : "pthread_rwlock_private";
+    static constexpr bool kProcessShared = ProcessShared;
+
+    template <typename Fn>
+    void read(Fn &&fn)
+    {
+        std::shared_lock<PthreadRwMutex> lock(mtx_);
+        fn();
+    }
+
+    template <typename Fn>
+    void write(Fn &&fn)
+    {
+        std::unique_lock<PthreadRwMutex> lock(mtx_);
+        fn();
+    }
+
+  private:
+    alignas(64) PthreadRwMutex mtx_{ ProcessShared };
+};
+
+using PthreadRwLock = BasicPthreadRwLock<true>;
+using PrivatePthreadRwLock = BasicPthreadRwLock<false>;
+
+/**
+ * @class SeqLock
+ * @brief Sequence lock: readers never write shared memory, they retry if a write overlapped.
+ * read(fn) may run fn several times and fn may see a torn state, so fn must
+ * publish nothing until read() returns. fn must load shared data with
+ * acquire and write(fn)'s fn store it with release: that orders the data
+ * between the two sequence increments without a fence.
+ */
+class SeqLock
+{
+  public:
+    static constexpr const char *kName = "seqlock";
+    static constexpr bool kProcessShared = true;
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+                  "a seqlock in shared memory needs lock-free atomics");
+
+    template <typename Fn>
+    void read(Fn &&fn)
+    {
+        SpinWait wait;
+        for (;;)
+        {
+            const std::uint32_t before = sequence_.load(std::memory_order_acquire);
+            if ((before & 1) == 0)
+            {
+                fn();
+                if (sequence_.load(std::memory_order_relaxed) == before)
+                {
+                    return;
+                }
+            }
+            wait.Once();
+        }
+    }
+
+    template <typename Fn>
+    void write(Fn &&fn)
+    {
+        SpinWait wait;
+        while (writer_.exchange(true, std::memory_order_acquire))
+        {
+            wait.Once();
+        }
+        sequence_.fetch_add(1, std::memory_order_relaxed);
+        fn();
+        sequence_.fetch_add(1, std::memory_order_release);
+        writer_.store(false, std::memory_order_release);
+    }
+
+  private:
+    /// @brief Odd while a write is in progress.
+    alignas(64) std::atomic<std::uint32_t> sequence_{ 0 };
+    /// @brief Serializes writers; readers never touch it.
+    alignas(64) std::atomic<bool> writer_{ false };
+};
+
+/**
+ * @struct SharedTable
+ * @brief kNumKeys values and the @p Lock that guards them, laid out for one shared mapping.
+ */
+template <typename Lock>
+struct SharedTable
+{
+    Lock lock;
+    alignas(64) std::atomic<double> values[kNumKeys];
+
+    static_assert(std::atomic<double>::is_always_lock_free, "shared values need lock-free atomics");
+
+    SharedTable()
+    {
+        for (int i = 0; i < kNumKeys; ++i)
+        {
+            values[i].store(std::sqrt(i), std::memory_order_relaxed);
+        }
+    }
+};
+
+/**
+ * @brief DoHeavyRead on the table: 50 lookups, each through sin().
+ */
+template <typename Lock>
+inline double HeavyTableRead(const SharedTable<Lock> &table)
+{
+    double total = 0;
+    for (int i = 0; i < 50; ++i)
+    {
+        total += std::sin(table.values[i % kNumKeys].load(std::memory_order_acquire));
+    }
+    return total;
+}
+
+/**
+ * @brief DoWrite on the table: values[0] += 1.1. Only ever called under the exclusive lock.
+ */
+template <typename Lock>
+inline void TableWrite(SharedTable<Lock> &table)
+{
+    table.values[0].store(table.values[0].load(std::memory_order_relaxed) + 1.1, std::memory_order_release);
+}
+
+/**
+ * @class SharedMemorySegment
+ * @brief Anonymous POSIX shared memory holding one @p T. The name is unlinked
+ * as soon as the segment is mapped, so nothing outlives the benchmark even if
+ * it crashes; processes forked after construction inherit the mapping.
+ */
+template <typename T>
+class SharedMemorySegment
+{
+  public:
+    SharedMemorySegment()
+    {
+        static std::atomic<int> created{ 0 };
+        const std::string name = "/lock_bench_" + std::to_string(getpid()) + "_" + std::to_string(created++);
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            return;
+        }
+        shm_unlink(name.c_str());
+        void *memory = MAP_FAILED;
+        if (ftruncate(fd, sizeof(T)) == 0)
+        {
+            memory = mmap(nullptr, sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (memory != MAP_FAILED)
+        {
+            object_ = new (memory) T();
+        }
+    }
+
+    ~SharedMemorySegment()
+    {
+        if (object_ != nullptr)
+        {
+            object_->~T();
+            munmap(object_, sizeof(T));
+        }
+    }
+
+    SharedMemorySegment(const SharedMemorySegment &) = delete;
+    SharedMemorySegment &operator=(const SharedMemorySegment &) = delete;
+
+    /// @brief The shared object, or nullptr if the segment could not be created.
+    T *get() const
+    {
+        return object_;
+    }
+
+  private:
+    T *object_ = nullptr;
+};
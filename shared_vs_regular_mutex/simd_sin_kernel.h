@@ -0,0 +1,215 @@
+/**
+ * @file simd_sin_kernel.h
+ * @brief Sum-of-sines kernels (scalar, AVX2, AVX-512) with runtime ISA selection.
+ * * DESIGN PRINCIPLE:
+ * The vector kernels share one algorithm: Cody-Waite reduction by pi to
+ * r in [-pi/2, pi/2], an odd Taylor polynomial up to r^17 (|error| < 1e-11),
+ * and a sign flip from the parity of the quotient. Each kernel is compiled
+ * with a function-level target attribute, so the translation unit itself
+ * needs no -mavx flags and runs on any x86-64; the best kernel the CPU
+ * supports is picked at runtime.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_SIN_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @enum SinKernel
+ * @brief Implementations of SumSin, ordered from least to most capable.
+ */
+enum class SinKernel
+{
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+/**
+ * @brief Human-readable kernel name, used as the benchmark label.
+ */
+inline const char *SinKernelName(SinKernel kernel)
+{
+    switch (kernel)
+    {
+    case SinKernel::Avx2:
+        return "avx2";
+    case SinKernel::Avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+/**
+ * @brief Returns true if this CPU can execute @p kernel.
+ */
+inline bool SinKernelSupported(SinKernel kernel)
+{
+#ifdef SIMD_SIN_X86
+    switch (kernel)
+    {
+    case SinKernel::Avx2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case SinKernel::Avx512:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        return true;
+    }
+#else
+    return kernel == SinKernel::Scalar;
+#endif
+}
+
+/**
+ * @brief The most capable kernel this CPU supports.
+ */
+inline SinKernel BestSinKernel()
+{
+    if (SinKernelSupported(SinKernel::Avx512))
+    {
+        return SinKernel::Avx512;
+    }
+    if (SinKernelSupported(SinKernel::Avx2))
+    {
+        return SinKernel::Avx2;
+    }
+    return SinKernel::Scalar;
+}
+
+/**
+ * @brief Reference kernel: sum of std::sin over @p n contiguous values.
+ */
+inline double SumSinScalar(const double *values, std::size_t n)
+{
+    double total = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        total += std::sin(values[i]);
+    }
+    return total;
+}
+
+#ifdef SIMD_SIN_X86
+
+namespace simd_sin_detail
+{
+/// @brief pi split in two so k * pi is subtracted without losing bits.
+constexpr double kPiHi = 3.141592653589793116;
+constexpr double kPiLo = 1.2246467991473532e-16;
+constexpr double kInvPi = 0.31830988618379067154;
+/// @brief 2^52 + 2^51: adding it rounds to an integer held in the low mantissa bits.
+constexpr double kRoundMagic = 6755399441055744.0;
+
+/// @brief Taylor coefficients of sin(r) / r in powers of r^2, highest first.
+constexpr double kC17 = 2.8114572543455206e-15;
+constexpr double kC15 = -7.6471637318198164e-13;
+constexpr double kC13 = 1.6059043836821613e-10;
+constexpr double kC11 = -2.5052108385441720e-08;
+constexpr double kC9 = 2.7557319223985893e-06;
+constexpr double kC7 = -1.9841269841269841e-04;
+constexpr double kC5 = 8.3333333333333333e-03;
+constexpr double kC3 = -1.6666666666666667e-01;
+} // namespace simd_sin_detail
+
+/**
+ * @brief AVX2 + FMA kernel: four doubles per step, scalar tail.
+ */
+__attribute__((target("avx2,fma"))) inline double SumSinAvx2(const double *values, std::size_t n)
+{
+    using namespace simd_sin_detail;
+    const __m256d magic = _mm256_set1_pd(kRoundMagic);
+    __m256d acc = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d x = _mm256_loadu_pd(values + i);
+        __m256d kd = _mm256_fmadd_pd(x, _mm256_set1_pd(kInvPi), magic);
+        // Parity of k moved to the sign bit.
+        __m256d sign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(kd), 63));
+        kd = _mm256_sub_pd(kd, magic);
+        __m256d r = _mm256_fnmadd_pd(kd, _mm256_set1_pd(kPiHi), x);
+        r = _mm256_fnmadd_pd(kd, _mm256_set1_pd(kPiLo), r);
+        __m256d r2 = _mm256_mul_pd(r, r);
+        __m256d p = _mm256_set1_pd(kC17);
+        p = _mm256_fmadd_pd(p, r2, _mm256_set1_pd(kC15));
+        p = _mm256_fmadd_pd(p, r2, _mm256_set1_pd(kC13));
+        p = _mm256_fmadd_pd(p, r2, _mm256_set1_pd(kC11));
+        p = _mm256_fmadd_pd(p, r2, _mm256_set1_pd(kC9));
+        p = _mm256_fmadd_pd(p, r2, _mm256_set1_pd(kC7));
+        p = _mm256_fmadd_pd(p, r2, _mm256_set1_pd(kC5));
+        p = _mm256_fmadd_pd(p, r2, _mm256_set1_pd(kC3));
+        p = _mm256_fmadd_pd(_mm256_mul_pd(p, r2), r, r);
+        acc = _mm256_add_pd(acc, _mm256_xor_pd(p, sign));
+    }
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double total = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    return total + SumSinScalar(values + i, n - i);
+}
+
+/**
+ * @brief AVX-512F kernel: eight doubles per step, masked tail.
+ */
+__attribute__((target("avx512f"))) inline double SumSinAvx512(const double *values, std::size_t n)
+{
+    using namespace simd_sin_detail;
+    const __m512d magic = _mm512_set1_pd(kRoundMagic);
+    __m512d acc = _mm512_setzero_pd();
+    for (std::size_t i = 0; i < n; i += 8)
+    {
+        const std::size_t remaining = n - i;
+        const __mmask8 mask = remaining >= 8 ? static_cast<__mmask8>(0xFF)
+                                             : static_cast<__mmask8>((1u << remaining) - 1);
+        __m512d x = _mm512_maskz_loadu_pd(mask, values + i);
+        __m512d kd = _mm512_fmadd_pd(x, _mm512_set1_pd(kInvPi), magic);
+        __m512i sign = _mm512_maskz_slli_epi64(0xFF, _mm512_castpd_si512(kd), 63);
+        kd = _mm512_sub_pd(kd, magic);
+        __m512d r = _mm512_fnmadd_pd(kd, _mm512_set1_pd(kPiHi), x);
+        r = _mm512_fnmadd_pd(kd, _mm512_set1_pd(kPiLo), r);
+        __m512d r2 = _mm512_mul_pd(r, r);
+        __m512d p = _mm512_set1_pd(kC17);
+        p = _mm512_fmadd_pd(p, r2, _mm512_set1_pd(kC15));
+        p = _mm512_fmadd_pd(p, r2, _mm512_set1_pd(kC13));
+        p = _mm512_fmadd_pd(p, r2, _mm512_set1_pd(kC11));
+        p = _mm512_fmadd_pd(p, r2, _mm512_set1_pd(kC9));
+        p = _mm512_fmadd_pd(p, r2, _mm512_set1_pd(kC7));
+        p = _mm512_fmadd_pd(p, r2, _mm512_set1_pd(kC5));
+        p = _mm512_fmadd_pd(p, r2, _mm512_set1_pd(kC3));
+        p = _mm512_fmadd_pd(_mm512_mul_pd(p, r2), r, r);
+        // Masked-off lanes loaded 0.0 and sin(0) == 0, so they add nothing.
+        p = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(p), sign));
+        acc = _mm512_add_pd(acc, p);
+    }
+    // Explicit maskz forms: the unmasked helpers trip GCC 12's -Wuninitialized.
+    __m256d quad = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xF, acc, 0), _mm512_maskz_extractf64x4_pd(0xF, acc, 1));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(quad), _mm256_extractf128_pd(quad, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+#endif // SIMD_SIN_X86
+
+/**
+ * @brief Sum of sin(values[i]) over @p n values using @p kernel.
+ * The caller must have checked SinKernelSupported(kernel).
+ */
+inline double SumSin(SinKernel kernel, const double *values, std::size_t n)
+{
+#ifdef SIMD_SIN_X86
+    switch (kernel)
+    {
+    case SinKernel::Avx2:
+        return SumSinAvx2(values, n);
+    case SinKernel::Avx512:
+        return SumSinAvx512(values, n);
+    default:
+        break;
+    }
+#endif
+    return SumSinScalar(values, n);
+}
@@ -0,0 +1,125 @@
+/**
+ * @file skip_list_vs_map_range_scan_bench.cpp
+ * @brief Ordered-container concurrency: a lazy skip list against the locked std::map.
+ * * DESIGN PRINCIPLE:
+ * Point lookups hide what an ordered container costs under concurrency. Here
+ * every reader sums the values over [k, k+R), so the read side walks R
+ * consecutive nodes. The std::map rows (read=scan in the lock matrix) hold
+ * the lock for the whole walk; the skip list takes no lock at all on the
+ * read path, so it is registered as lock=none with the same scan lengths.
+ * As in the map rows, the writer either updates key 0 in place
+ * (write=update, a CAS on the value) or erases and reinserts one key per
+ * iteration (write=insert_erase), which goes through the per-node locks,
+ * marking and validation of the skip list while readers walk past.
+ */
+
+#include "bench_registry.h"
+#include "concurrent_skip_list.h"
+#include "map_workloads.h"
+#include "suites.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+
+/**
+ * @struct SkipListContext
+ * @brief Holds the same keys and values as the map so scans do equal work.
+ */
+struct SkipListContext
+{
+    /// @brief Lock-free on the read side; needs no external lock.
+    ConcurrentSkipList<int, double> skip_list;
+
+    /**
+     * @brief Fills the skip list. Called once per run, before any thread starts.
+     */
+    void setup()
+    {
+        for (int i = 0; i < kNumKeys; ++i)
+        {
+            skip_list.insert(i, std::sqrt(i));
+        }
+    }
+};
+
+/**
+ * @brief Range-scan read over the skip list: sum of values in [lo, lo + length).
+ */
+void DoSkipListRangeScan(const SkipListContext &ctx, int lo, int length)
+{
+    double total = 0;
+    ctx.skip_list.for_each_in_range(lo, lo + length, [&total](int, double value) { total += value; });
+    benchmark::DoNotOptimize(total);
+}
+
+/**
+ * @brief Insert/Erase Write Workload on the skip list, as DoInsertEraseWrite
+ * does on the map: erases the next key and reinserts it with its value + 1.1.
+ * Without an exclusive lock a concurrent scan may miss the key in between.
+ */
+void DoSkipListInsertErase(SkipListContext &ctx, int &cursor)
+{
+    const int key = cursor;
+    cursor = (cursor + 1) % kNumKeys;
+    double value = 0;
+    ctx.skip_list.find_value(key, value);
+    ctx.skip_list.erase(key);
+    benchmark::DoNotOptimize(ctx.skip_list.insert(key, value + 1.1));
+}
+
+/**
+ * @brief Readers never lock; the writer updates the value in place with a CAS
+ * or, with @p insert_erase, erases and reinserts a key.
+ */
+void RegisterSkipListRangeScan(int length, bool insert_erase)
+{
+    BenchName name;
+    name.Add("lock", "none").Add("container", "skip_list").Add("read", "scan").Add("scan_len", length);
+    name.Add("write", insert_erase ? "insert_erase" : "update").Add("load", "closed");
+    RegisterWithContext<SkipListContext>(name, [length, insert_erase](benchmark::State &state,
+                                                                      SkipListContext &ctx) {
+        int cursor = state.thread_index();
+        int write_cursor = 0;
+        std::int64_t reads = 0;
+        for (auto _ : state)
+        {
+            if (state.thread_index() == 0)
+            {
+                if (insert_erase)
+                {
+                    DoSkipListInsertErase(ctx, write_cursor);
+                }
+                else
+                {
+                    benchmark::DoNotOptimize(ctx.skip_list.add(0, 1.1));
+                }
+            }
+            else
+            {
+                DoSkipListRangeScan(ctx, NextScanStart(cursor, length), length);
+                ++reads;
+            }
+        }
+        ReportReads(state, reads, state.threads() - 1);
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
+}
+
+} // namespace
+
+void RegisterSkipListBenchmarks()
+{
+    // Short, medium and long scans, as in the map rows of the lock matrix.
+    for (bool insert_erase : { false, true })
+    {
+        for (int length : { 10, 100, 1000 })
+        {
+            RegisterSkipListRangeScan(length, insert_erase);
+        }
+    }
+}
@@ -0,0 +1,186 @@
+/**
+ * @file soa_simd_heavy_read_bench.cpp
+ * @brief How a shorter critical section moves the std::mutex vs std::shared_mutex crossover.
+ * * DESIGN PRINCIPLE:
+ * DoHeavyRead fetches 50 values one node at a time from a std::map and calls
+ * std::sin on each. Here the same values are also stored contiguously
+ * (structure-of-arrays) and reduced by a vectorized kernel chosen at runtime.
+ * Comparing container=soa against the container=map rows of the lock matrix
+ * shows how much of shared_mutex's advantage was really just a long
+ * critical section.
+ */
+
+#include "bench_registry.h"
+#include "lock_policies.h"
+#include "map_workloads.h"
+#include "simd_sin_kernel.h"
+#include "suites.h"
+
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+/// @brief Values reduced per read, as in DoHeavyRead.
+constexpr int kReadWidth = 50;
+
+/**
+ * @struct SoaContext
+ * @brief Structure-of-arrays copy of the map: values[k] == sqrt(k).
+ * * Keys are the dense range [0, kNumKeys), so in the SoA layout the key is
+ * the index and only the values array needs storing.
+ */
+template <typename Lock>
+struct SoaContext
+{
+    std::vector<double> values;
+    Lock lock;
+
+    /**
+     * @brief Fills the values. Called once per run, before any thread starts.
+     */
+    void setup()
+    {
+        values.resize(kNumKeys);
+        for (int i = 0; i < kNumKeys; ++i)
+        {
+            values[i] = std::sqrt(i);
+        }
+    }
+};
+
+/**
+ * @brief Unlocked context for the single-threaded critical-section benchmarks.
+ */
+struct CriticalSectionContext
+{
+    MapData data;
+    std::vector<double> values;
+
+    void setup()
+    {
+        FillMap(data);
+        values.resize(kNumKeys);
+        for (int i = 0; i < kNumKeys; ++i)
+        {
+            values[i] = std::sqrt(i);
+        }
+    }
+};
+
+/**
+ * @brief Heavy Read Workload, SoA layout: one contiguous block through @p kernel.
+ */
+void DoSoaHeavyRead(const std::vector<double> &values, SinKernel kernel)
+{
+    double total = SumSin(kernel, values.data(), kReadWidth);
+    benchmark::DoNotOptimize(total);
+}
+
+/**
+ * @brief Write Workload, SoA layout.
+ */
+void DoSoaWrite(std::vector<double> &values)
+{
+    values[0] += 1.1;
+    benchmark::DoNotOptimize(values[0]);
+}
+
+/**
+ * @brief Skips the run if the CPU lacks @p kernel.
+ */
+bool CheckKernel(benchmark::State &state, SinKernel kernel)
+{
+    if (!SinKernelSupported(kernel))
+    {
+        state.SkipWithError("kernel not supported on this CPU");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Critical-section length of each read variant: no lock, one thread.
+ * The map + std::sin row is the baseline for the SoA kernels.
+ */
+void RegisterCriticalSections()
+{
+    BenchName map_name;
+    map_name.Add("lock", "none").Add("container", "map").Add("read", "heavy").Add("load", "single");
+    RegisterWithContext<CriticalSectionContext>(map_name, [](benchmark::State &state, CriticalSectionContext &ctx) {
+        for (auto _ : state)
+        {
+            DoHeavyRead(ctx.data);
+        }
+    })
+        ->UseRealTime();
+    for (SinKernel kernel : { SinKernel::Scalar, SinKernel::Avx2, SinKernel::Avx512 })
+    {
+        BenchName name;
+        name.Add("lock", "none").Add("container", "soa").Add("kernel", SinKernelName(kernel));
+        name.Add("read", "heavy").Add("load", "single");
+        RegisterWithContext<CriticalSectionContext>(name, [kernel](benchmark::State &state,
+                                                                   CriticalSectionContext &ctx) {
+            if (!CheckKernel(state, kernel))
+            {
+                return;
+            }
+            for (auto _ : state)
+            {
+                DoSoaHeavyRead(ctx.values, kernel);
+            }
+        })
+            ->UseRealTime();
+    }
+}
+
+/**
+ * @brief One writer, N-1 readers over the SoA layout with @p kernel.
+ * With the vector kernels the read is short enough that shared_mutex's
+ * heavier acquire can cost more than the parallelism it buys.
+ */
+template <typename Lock>
+void RegisterSoaHeavyRead(SinKernel kernel)
+{
+    BenchName name;
+    name.Add("lock", Lock::kName).Add("container", "soa").Add("kernel", SinKernelName(kernel));
+    name.Add("read", "heavy").Add("write", "update").Add("load", "closed");
+    RegisterWithContext<SoaContext<Lock>>(name, [kernel](benchmark::State &state, SoaContext<Lock> &ctx) {
+        if (!CheckKernel(state, kernel))
+        {
+            return;
+        }
+        std::int64_t reads = 0;
+        for (auto _ : state)
+        {
+            if (state.thread_index() == 0)
+            {
+                ctx.lock.write([&] { DoSoaWrite(ctx.values); });
+            }
+            else
+            {
+                ctx.lock.read([&] { DoSoaHeavyRead(ctx.values, kernel); });
+                ++reads;
+            }
+        }
+        ReportReads(state, reads, state.threads() - 1);
+    })
+        ->Apply(SweepThreads)
+        ->UseRealTime();
+}
+
+} // namespace
+
+void RegisterSoaBenchmarks()
+{
+    RegisterCriticalSections();
+    AllLockPolicies::ForEach([](auto tag) {
+        for (SinKernel kernel : { SinKernel::Scalar, SinKernel::Avx2, SinKernel::Avx512 })
+        {
+            RegisterSoaHeavyRead<typename decltype(tag)::type>(kernel);
+        }
+    });
+}
@@ -0,0 +1,28 @@
+/**
+ * @file suites.h
+ * @brief Registration entry points of the benchmark suites linked into lock_bench.
+ * * DESIGN PRINCIPLE:
+ * Each suite is one translation unit that registers its benchmarks when
+ * main() calls its function, so the registration order is the order below
+ * and never depends on static initialization.
+ */
+
+#pragma once
+
+/// @brief Every lock policy x read x write x load model (shared_mutex_vs_mutex_bench.cpp).
+void RegisterLockBenchmarks();
+
+/// @brief Lock-free skip list range scans (skip_list_vs_map_range_scan_bench.cpp).
+void RegisterSkipListBenchmarks();
+
+/// @brief SoA layout with SIMD read kernels (soa_simd_heavy_read_bench.cpp).
+void RegisterSoaBenchmarks();
+
+/// @brief Map node allocators (pmr_map_locality_bench.cpp).
+void RegisterPmrBenchmarks();
+
+/// @brief Two-thread lock hand-off latency by CPU distance (lock_handoff_bench.cpp).
+void RegisterHandoffBenchmarks();
+
+/// @brief Process-shared locks over a table in POSIX shared memory (cross_process_bench.cpp).
+void RegisterCrossProcessBenchmarks();
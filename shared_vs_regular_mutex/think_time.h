@@ -0,0 +1,75 @@
+/**
+ * @file think_time.h
+ * @brief Calibrated non-locked work ("think time") between critical sections.
+ * * DESIGN PRINCIPLE:
+ * Real threads do something between lock acquisitions. Think time is a plain
+ * CPU spin of a calibrated number of iterations rather than a clock poll, so
+ * it behaves like real work: it keeps the core busy, and it is not cut short
+ * or stretched by the clock source. The iteration rate is measured once per
+ * process. Frequency scaling during a run skews it, so pin the governor.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Executes @p iterations rounds of opaque busy work.
+ */
+inline void SpinIterations(std::uint64_t iterations)
+{
+    for (std::uint64_t i = 0; i < iterations; ++i)
+    {
+        benchmark::DoNotOptimize(i);
+    }
+}
+
+/**
+ * @brief Mean wall-clock cost of @p fn in nanoseconds over @p reps calls.
+ */
+template <typename Fn>
+double MeanNs(Fn &&fn, int reps)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; ++i)
+    {
+        fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / reps;
+}
+
+/**
+ * @brief SpinIterations rounds per nanosecond on this machine, measured on first use.
+ */
+inline double SpinIterationsPerNs()
+{
+    static const double rate = [] {
+        constexpr std::uint64_t kCalibrationIterations = 20'000'000;
+        SpinIterations(kCalibrationIterations / 10); // warm up / ramp the clock
+        const double ns = MeanNs([] { SpinIterations(kCalibrationIterations); }, 1);
+        return static_cast<double>(kCalibrationIterations) / ns;
+    }();
+    return rate;
+}
+
+/**
+ * @brief Burns roughly @p ns nanoseconds of CPU outside any lock.
+ */
+inline void ThinkFor(std::uint64_t ns)
+{
+    SpinIterations(static_cast<std::uint64_t>(static_cast<double>(ns) * SpinIterationsPerNs()));
+}
+
+/**
+ * @brief Think time that puts a thread's lock duty cycle at @p duty_pct percent,
+ * given a critical section costing @p critical_section_ns.
+ * duty = cs / (cs + think), so think = cs * (100 - duty) / duty.
+ */
+inline std::uint64_t ThinkNsForDutyCycle(double critical_section_ns, int duty_pct)
+{
+    return static_cast<std::uint64_t>(critical_section_ns * (100 - duty_pct) / duty_pct);
+}
@@ -0,0 +1,166 @@
+/**
+ * @file upgrade_mutex.h
+ * @brief Reader-writer lock with an upgradeable mode (the model of Boost's upgrade_mutex).
+ * * DESIGN PRINCIPLE:
+ * A check-then-write path under std::shared_mutex must drop its shared lock,
+ * take the exclusive one and look the data up again, because another thread
+ * may have written in between. Upgrade ownership closes that gap: it admits
+ * readers but excludes writers and other upgraders, so the holder can turn
+ * it into exclusive ownership, once the readers already inside have left,
+ * and nobody can have written in between. Only one thread can hold upgrade
+ * ownership at a time, so check-then-write paths serialize among themselves.
+ */
+
+#pragma once
+
+#include "spin_wait.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @class UpgradeMutex
+ * @brief Shared, upgrade and exclusive ownership in one 32-bit word.
+ * A waiting writer or upgrader raises kPending, which stops new readers and
+ * upgraders from entering, so a stream of readers cannot starve it.
+ */
+class UpgradeMutex
+{
+  public:
+    void lock_shared()
+    {
+        SpinWait wait;
+        for (;;)
+        {
+            std::uint32_t state = state_.load(std::memory_order_relaxed);
+            if ((state & (kWriter | kPending)) == 0 &&
+                state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire))
+            {
+                return;
+            }
+            wait.Once();
+        }
+    }
+
+    void unlock_shared()
+    {
+        state_.fetch_sub(1, std::memory_order_release);
+    }
+
+    void lock_upgrade()
+    {
+        SpinWait wait;
+        for (;;)
+        {
+            std::uint32_t state = state_.load(std::memory_order_relaxed);
+            if ((state & (kWriter | kUpgrader | kPending)) == 0 &&
+                state_.compare_exchange_weak(state, state | kUpgrader, std::memory_order_acquire))
+            {
+                return;
+            }
+            wait.Once();
+        }
+    }
+
+    void unlock_upgrade()
+    {
+        state_.fetch_and(~kUpgrader, std::memory_order_release);
+    }
+
+    /**
+     * @brief Upgrade to exclusive ownership: waits for the readers already inside.
+     * Writers cannot get in meanwhile, since they wait for kUpgrader to clear.
+     */
+    void unlock_upgrade_and_lock()
+    {
+        state_.fetch_or(kPending, std::memory_order_relaxed);
+        SpinWait wait;
+        for (;;)
+        {
+            std::uint32_t state = state_.load(std::memory_order_relaxed);
+            if ((state & kReaderMask) == 0 &&
+                state_.compare_exchange_weak(state, (state & ~(kUpgrader | kPending)) | kWriter,
+                                             std::memory_order_acquire))
+            {
+                return;
+            }
+            wait.Once();
+        }
+    }
+
+    void lock()
+    {
+        SpinWait wait;
+        for (;;)
+        {
+            std::uint32_t state = state_.load(std::memory_order_relaxed);
+            if ((state & (kWriter | kUpgrader | kReaderMask)) == 0)
+            {
+                if (state_.compare_exchange_weak(state, (state & ~kPending) | kWriter, std::memory_order_acquire))
+                {
+                    return;
+                }
+            }
+            else if ((state & kPending) == 0)
+            {
+                state_.fetch_or(kPending, std::memory_order_relaxed);
+            }
+            wait.Once();
+        }
+    }
+
+    void unlock()
+    {
+        state_.fetch_and(~kWriter, std::memory_order_release);
+    }
+
+  private:
+    static constexpr std::uint32_t kWriter = 1u << 31;
+    static constexpr std::uint32_t kUpgrader = 1u << 30;
+    /// @brief A writer or upgrader is waiting; set by any of them, cleared by whichever gets in.
+    static constexpr std::uint32_t kPending = 1u << 29;
+    static constexpr std::uint32_t kReaderMask = kPending - 1;
+
+    std::atomic<std::uint32_t> state_{ 0 };
+};
+
+/**
+ * @class UpgradeLock
+ * @brief RAII upgrade ownership of an UpgradeMutex, released on destruction
+ * unless Upgrade() has turned it into exclusive ownership.
+ */
+class UpgradeLock
+{
+  public:
+    explicit UpgradeLock(UpgradeMutex &mtx) : mtx_(&mtx)
+    {
+        mtx_->lock_upgrade();
+    }
+
+    ~UpgradeLock()
+    {
+        if (mtx_ != nullptr)
+        {
+            mtx_->unlock_upgrade();
+        }
+    }
+
+    UpgradeLock(const UpgradeLock &) = delete;
+    UpgradeLock &operator=(const UpgradeLock &) = delete;
+
+    /**
+     * @brief Waits for the readers inside to leave and returns the exclusive
+     * ownership; this guard no longer owns anything.
+     */
+    std::unique_lock<UpgradeMutex> Upgrade()
+    {
+        UpgradeMutex *mtx = mtx_;
+        mtx_ = nullptr;
+        mtx->unlock_upgrade_and_lock();
+        return std::unique_lock<UpgradeMutex>(*mtx, std::adopt_lock);
+    }
+
+  private:
+    UpgradeMutex *mtx_;
+};